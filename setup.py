@@ -26,11 +26,13 @@ setup(
         Extension("_linzgrid", [
             "src/linzgrid/_linzgrid.c",
             "src/linzgrid/linzgrid.c",
+            "src/linzgrid/linzgridregistry.c",
             "src/linzgrid/linzgridnzgd2k.c"
         ]),
         Extension("_nz_geodetic", [
             "src/nz_geodetic/_nz_geodetic.c",
             "src/linzgrid/linzgrid.c",
+            "src/linzgrid/linzgridregistry.c",
             "src/linzgrid/linzgridnzgd2k.c",
             "src/nzmg/nzmg.c",
             "src/nztm/nztm.c"
@@ -1,9 +1,10 @@
 #include <Python.h>
 #include "linzgrid.h"
 #include "linzgridnzgd2k.h"
+#include "linzgridregistry.h"
 
-#define NZGD49_TO_NZGD2000 0
-#define NZGD2000_TO_NZGD49 1
+#define NZGD49 "NZGD49"
+#define NZGD2000 "NZGD2000"
 
 static char module_docstring[] =
   "A module for converting between NZGD1949 and NZGD2000.\
@@ -32,23 +33,38 @@ static PyMethodDef module_methods[] = {
     {NULL, NULL, 0, NULL}
 };
 
-lnzGrid linz_grid;
+lnzGridRegistry *linz_grids;
 
 PyMODINIT_FUNC init_linzgrid(void)
 {
+    lnzGrid *grid;
     PyObject *m = Py_InitModule3("_linzgrid", module_methods, module_docstring);
     if (m == NULL)
         return;
 
-  linz_grid = *lnzGridNzgd2k();
+    linz_grids = lnzGridRegistryCreate();
+    grid = lnzGridCreateNzgd2k();
 
-    if (!lnzGridIsOk(&linz_grid)) {
-        PyErr_SetString(PyExc_RuntimeError, lnzGridLastError(&linz_grid));
-        lnzGridDestroy(&linz_grid);
+    if (!linz_grids || !lnzGridRegistryAdd(linz_grids, grid)) {
+        PyErr_SetString(PyExc_RuntimeError, lnzGridLastError(grid));
+        lnzGridDestroy(grid);
+        free(grid);
         return;
     }
 }
 
+static int linz_transform(const char *datum0, const char *datum1,
+                          double lts, double lns, double *ltd, double *lnd)
+{
+    int reverse, ok;
+    lnzGrid *grid = lnzGridRegistryFind(linz_grids, datum0, datum1, &reverse);
+    if (!grid)
+        return 0;
+    ok = lnzGridTransform(grid, lts, lns, ltd, lnd, reverse);
+    lnzGridRelease(grid);
+    return ok;
+}
+
 static PyObject *linz_nzgd2000_nzgd1949(PyObject *self, PyObject *args)
 {
     double lt_2000, ln_2000, lt_1949, ln_1949; /* latitude (rad), longitude (rad) */
@@ -58,7 +74,7 @@ static PyObject *linz_nzgd2000_nzgd1949(PyObject *self, PyObject *args)
         return NULL;
 
     //TODO: test return code
-    lnzGridTransform(&linz_grid, lt_1949, ln_1949, &lt_2000, &ln_2000, NZGD2000_TO_NZGD49);
+    linz_transform(NZGD2000, NZGD49, lt_2000, ln_2000, &lt_1949, &ln_1949);
 
     {
         PyObject *ret = Py_BuildValue("dd", lt_1949, ln_1949);
@@ -75,7 +91,7 @@ static PyObject *linz_nzgd1949_nzgd2000(PyObject *self, PyObject *args)
         return NULL;
 
     //TODO: test return code
-    lnzGridTransform(&linz_grid, lt_1949, ln_1949, &lt_2000, &ln_2000, NZGD49_TO_NZGD2000);
+    linz_transform(NZGD49, NZGD2000, lt_1949, ln_1949, &lt_2000, &ln_2000);
 
     {
         PyObject *ret = Py_BuildValue("dd", lt_2000, ln_2000);
@@ -0,0 +1,112 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  Benchmark for the batch grid transformation.  Builds a synthetic grid
+*  much larger than the processor cache, and times lnzGridTransformBatch
+*  on randomly scattered points with a range of prefetch distances (see
+*  lnzGridSetPrefetch).  
+*
+*  Syntax: benchlinzgrid [nlat nlon [npt [repeat]]]
+*
+*  The default grid is 2000 x 4000 nodes (64 MB).
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "linzgrid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int distances[] = { -1, 4, 8, 16, 32, 64, 128 };
+
+int main( int argc, char *argv[] ) {
+   lnzGrid *grid;
+   int nlat, nlon, npt, repeat;
+   int nlt, nln, i, nd, nr;
+   double *lts, *lns, *ltd, *lnd;
+   double elapsed, base;
+   clock_t start;
+   float *f;
+
+   nlat = 2000;
+   nlon = 4000;
+   npt = 1000000;
+   repeat = 5;
+   if( argc > 2 ) { nlat = atoi(argv[1]); nlon = atoi(argv[2]); }
+   if( argc > 3 ) npt = atoi(argv[3]);
+   if( argc > 4 ) repeat = atoi(argv[4]);
+
+   /* A smooth synthetic shift field of a few arc seconds */
+
+   grid = lnzGridCreate( -48.0, 0.01, nlat, 166.0, 0.01, nlon );
+   if( ! lnzGridIsOk( grid ) ) {
+      fprintf(stderr,"Error: %s\n", lnzGridLastError(grid) );
+      return 2;
+      }
+   for( nlt = 0; nlt < nlat; nlt++ ) {
+      f = grid->grid[nlt];
+      for( nln = 0; nln < nlon; nln++, f += 2 ) {
+         f[0] = (float) (0.001*sin(nlt*0.01) + 0.0005*cos(nln*0.013));
+         f[1] = (float) (0.0008*cos(nlt*0.011) - 0.0003*sin(nln*0.007));
+         }
+      }
+
+   lts = (double *) malloc( npt*sizeof(double) );
+   lns = (double *) malloc( npt*sizeof(double) );
+   ltd = (double *) malloc( npt*sizeof(double) );
+   lnd = (double *) malloc( npt*sizeof(double) );
+   if( ! lts || ! lns || ! ltd || ! lnd ) {
+      fprintf(stderr,"Error: Cannot allocate points\n");
+      return 2;
+      }
+
+   srand( 1 );
+   for( i = 0; i < npt; i++ ) {
+      lts[i] = grid->lat0 + (grid->lat1 - grid->lat0)*(rand()/(RAND_MAX+1.0));
+      lns[i] = grid->lon0 + (grid->lon1 - grid->lon0)*(rand()/(RAND_MAX+1.0));
+      }
+
+   printf("Grid %d x %d (%.1f MB), %d random points\n", nlat, nlon,
+          (double) nlat*nlon*2*sizeof(float)/(1024.0*1024.0), npt );
+
+   base = 0.0;
+   for( nd = 0; nd < (int) (sizeof(distances)/sizeof(int)); nd++ ) {
+      lnzGridSetPrefetch( grid, distances[nd] );
+      lnzGridTransformBatch( grid, npt, lts, lns, ltd, lnd, 0, NULL );
+      start = clock();
+      for( nr = 0; nr < repeat; nr++ ) {
+         lnzGridTransformBatch( grid, npt, lts, lns, ltd, lnd, 0, NULL );
+         }
+      elapsed = (double) (clock() - start)/CLOCKS_PER_SEC;
+      elapsed *= 1.0e9/((double) npt*repeat);
+      if( nd == 0 ) base = elapsed;
+      if( distances[nd] < 0 ) {
+         printf("  no prefetch        %7.2f ns/point\n", elapsed );
+         }
+      else {
+         printf("  prefetch %3d       %7.2f ns/point  (%.2fx)\n", 
+                distances[nd], elapsed, base/elapsed );
+         }
+      }
+
+   free( lts );
+   free( lns );
+   free( ltd );
+   free( lnd );
+   lnzGridDestroy( grid );
+   free( grid );
+   return 0;
+   }
+
+#ifdef __cplusplus
+};
+#endif
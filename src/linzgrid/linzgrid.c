@@ -25,14 +25,15 @@
 *
 ***********************************************************************
 *  To create a standalone test program compile this with the 
-*  linzgridload.c and testlinzgrid.c.
+*  linzgridload.c, linzgridpyramid.c, linzgridquad.c and testlinzgrid.c.
 *
 *  This program can be used to convert a data
 *  file of latitude/longitude values.
 *
 *  The program generated has the following command line syntax:
 *
-*  linzgrid [-q] [-r] grid_file input_file [output_file]
+*  linzgrid [-q] [-r] [-b] [-f] [-t tolerance] [-c tolerance] [-s name]
+*           [-H] grid_file input_file [output_file]
 *
 *  The parameters are
 *     grid_file   The name of the NTv2 Ascii grid file defining
@@ -50,6 +51,20 @@
 *  The options are
 *     -q          Suppresses printing information about the grid
 *     -r          Applies the reverse transformation to the coordinates
+*     -b          Converts the whole file with lnzGridTransformBatch
+*     -f          As for -b, but points outside the grid are converted 
+*                 with the NZGD1949 to NZGD2000 Helmert transformation
+*     -t tolerance Uses the smallest level of a grid pyramid (see
+*                 linzgridpyramid.c) that is accurate to the tolerance
+*     -c tolerance Uses a quadtree representation of the grid (see 
+*                 linzgridquad.c) built to the tolerance
+*     -s name     Publishes the grid to a shared memory segment (see
+*                 linzgridshm.c) and uses the grid attached from it
+*     -H          Backs the grid data with huge pages if possible (see
+*                 linzgridhuge.c)
+*     -j          Lists the Jacobian of the forward and reverse 
+*                 transformations at each point, checked against finite
+*                 differences
 *  
 ***********************************************************************
 *  This module provides the following functions for applying grid based
@@ -78,6 +93,28 @@
 *  
 *----------------------------------------------------------------------
 *
+*  lnzGrid *lnzGridCreate( double lat0, double dlat, int nlat,
+*                          double lon0, double dlon, int nlon );
+*
+*     Creates a lnzGrid object with the specified dimensions, and with
+*     the grid data allocated as a single block initiallized to zero. 
+*     This is used to build grids derived from other grids.
+*
+*     Parameters
+*        lat0      The minimum latitude
+*        dlat      The latitude increment
+*        nlat      The number of latitude grid values
+*        lon0      The minimum longitude
+*        dlon      The longitude increment
+*        nlon      The number of longitude grid values
+*
+*     Returns
+*        lnzGrid * A lnzGrid object handle, which may be tested with
+*                  lnzGridIsOk as for lnzGridCreateFromNTv2Asc.  The 
+*                  datum names are empty.
+*  
+*----------------------------------------------------------------------
+*
 *  void lnzGridDestroy( lnzGrid *grid );
 *  
 *     Destroys the lnzGrid object created using the lnzGridCreateFromNTv2Asc
@@ -91,6 +128,23 @@
 *  
 *----------------------------------------------------------------------
 *
+*  lnzGrid *lnzGridAddRef( lnzGrid *grid );
+*  void lnzGridRelease( lnzGrid *grid );
+*
+*     Reference counting for grids shared between several users, such
+*     as grids held in a registry (see linzgridregistry.c).  A grid 
+*     starts with no references.  lnzGridAddRef adds a reference and 
+*     returns the grid.  lnzGridRelease removes a reference, and when
+*     the last reference is removed destroys the grid and frees the
+*     lnzGrid structure itself.  Grids that are never given a reference
+*     are destroyed with lnzGridDestroy as before.  Both functions are
+*     safe to call from several threads at once.
+*
+*     Parameters
+*        grid      The handle of the grid object
+*
+*----------------------------------------------------------------------
+*
 *  int lnzGridIsOk( lnzGrid *grid );
 *  
 *     Returns the status of the grid.  The status is set when the grid is
@@ -166,7 +220,158 @@
 *                  successful.  If this is zero (false) then the transformation
 *                  was unsuccessful.  If the transformtion was unsuccessful then
 *                  the lnzGridLastError function can be used to find out why.
-*  
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridShift( lnzGrid *grid, double lts, double lns, 
+*                     double *ltshift, double *lnshift );
+*
+*     Returns the interpolated latitude and longitude shift at a point.
+*     No range checking is done - points outside the grid are 
+*     extrapolated from the nearest grid cell.  This is used to resample
+*     grids.
+*
+*     Parameters
+*        grid      The handle of the grid object
+*        lts       The latitude
+*        lns       The longitude
+*        ltshift   Pointer to the output latitude shift
+*        lnshift   Pointer to the output longitude shift
+*
+*     Returns
+*        none
+*
+*----------------------------------------------------------------------
+*
+*  double lnzGridShiftDistance( double lat, double dlt, double dln );
+*
+*     Converts a difference in latitude and longitude (degrees) at a 
+*     specified latitude to an approximate distance in metres.  This is
+*     used to express the error of resampled grids.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridSetNoData( lnzGrid *grid, double nodata );
+*
+*     Identifies grid nodes that have no data, and builds a packed bitmap
+*     of the grid cells for which all four corner nodes have data.  Points
+*     in cells without data are then rejected by the transformation
+*     functions.
+*
+*     Parameters
+*        grid      The handle of the grid object
+*        nodata    The value used in the grid file (in seconds of arc)
+*                  to flag a node without data.  Nodes for which either
+*                  the latitude or longitude shift equals this value are
+*                  treated as missing.
+*
+*     Returns
+*        int       The number of grid cells with data, or -1 if the
+*                  bitmap could not be allocated.  If every cell has
+*                  data no bitmap is kept.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridTransformBatch( lnzGrid *grid, int npt,
+*                        const double *lts, const double *lns,
+*                        double *ltd, double *lnd, int reverse,
+*                        unsigned char *status );
+*
+*     Applies lnzGridTransform to an array of points.  The bounding box
+*     of the points is calculated first, and if it lies entirely within
+*     a grid that has no missing data the points are transformed without
+*     any per point range checking.  Otherwise a mask of the valid points
+*     is built and applied to the results.
+*
+*     Parameters
+*        grid      The handle of the grid object applying the transformation
+*        npt       The number of points to transform
+*        lts       Array of input latitudes
+*        lns       Array of input longitudes
+*        ltd       Array of output latitudes (may be the same as lts)
+*        lnd       Array of output longitudes (may be the same as lns)
+*        reverse   As for lnzGridTransform
+*        status    Array receiving the status of each point, one of
+*                  LNZGRID_PT_GRID, LNZGRID_PT_HELMERT (transformed by the
+*                  Helmert fallback), or LNZGRID_PT_OUTSIDE.  May be NULL.
+*                  Points that are not transformed are copied unchanged
+*                  to the output arrays.
+*
+*     Returns
+*        int       The number of points successfully transformed.
+*                  The grid error message is not altered by this function,
+*                  so it may be used by several threads at once.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridSetHelmertFallback( lnzGrid *grid, const lnzHelmert *hlm,
+*                        double margin );
+*
+*     Defines a 7 parameter similarity transformation that 
+*     lnzGridTransformBatch applies to points that are outside the grid
+*     or in cells without data.  The transformation is calculated via 
+*     geocentric XYZ coordinates, assuming zero ellipsoidal height.  The
+*     reverse transformation uses the negated parameters.
+*
+*     Parameters
+*        grid      The handle of the grid object
+*        hlm       The transformation parameters, or NULL to turn off
+*                  the fallback.  The parameters are copied.
+*        margin    The distance in degrees outside the grid extents within
+*                  which the fallback is applied.  If this is negative 
+*                  the fallback is applied to all points.
+*
+*     Returns
+*        none
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridTransformJacobian( lnzGrid *grid, int npt,
+*                        const double *lts, const double *lns,
+*                        double *ltd, double *lnd, double *jac,
+*                        int reverse, unsigned char *status );
+*
+*     As for lnzGridTransformBatch, but also calculates the Jacobian of
+*     the transformation at each point, for use in propagating the 
+*     covariance of the coordinates.  The Jacobian is calculated 
+*     analytically from the bilinear interpolation, using the same grid
+*     values as the shift.
+*
+*     Parameters
+*        jac       Array of 4 values per point receiving the Jacobian 
+*                  d(ltd)/d(lts), d(ltd)/d(lns), d(lnd)/d(lts), 
+*                  d(lnd)/d(lns).  Points that are not transformed using
+*                  the grid (including points transformed by the Helmert
+*                  fallback, for which the derivative of the shift is 
+*                  negligible) are given the identity matrix.
+*
+*     Other parameters and the return value are as for 
+*     lnzGridTransformBatch.
+*
+*----------------------------------------------------------------------
+*
+*  const lnzHelmert *lnzGridHelmertNzgd49( void );
+*
+*     Returns the published NZGD1949 to NZGD2000 7 parameter 
+*     transformation (accurate to about 4 metres), suitable for use as
+*     the fallback for the NZGD1949 to NZGD2000 grid.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridSetPrefetch( lnzGrid *grid, int distance );
+*
+*     Sets how far ahead lnzGridTransformBatch and lnzGridTransformJacobian
+*     prefetch the grid cells needed for upcoming points.  The best 
+*     distance depends on the processor and on how scattered the points
+*     are (see benchlinzgrid.c).  Prefetching only helps when the grid 
+*     is much larger than the processor cache.
+*
+*     Parameters
+*        grid      The handle of the grid object
+*        distance  The number of points ahead to prefetch.  0 selects 
+*                  the default (LNZGRID_PREFETCH_DISTANCE), and a 
+*                  negative value disables prefetching.
+*
 *
 ***********************************************************************
 *
@@ -192,6 +397,7 @@
 #include <ctype.h>
 
 #include "linzgrid.h"
+#include "linzgridatomic.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -203,6 +409,57 @@ static char *notalloc = "Not enough memory to create grid";
 static char *nodatum = "";
 
 
+/***********************************************************************
+*   lnzGridCreate
+*
+*   Function to create an empty grid of the specified dimensions.  The 
+*   grid data is allocated as a single block, with the row pointers 
+*   pointing into it.
+***********************************************************************
+*/
+
+lnzGrid *lnzGridCreate( double lat0, double dlat, int nlat,
+                        double lon0, double dlon, int nlon ){
+   lnzGrid *grid;
+   int nlt;
+
+   grid = (lnzGrid *) calloc( 1, sizeof(lnzGrid) );
+   if( ! grid ) return grid;
+
+   grid->lat0 = lat0;
+   grid->dlat = dlat;
+   grid->nlat = nlat;
+   grid->lat1 = lat0 + dlat*(nlat-1);
+   grid->lon0 = lon0;
+   grid->dlon = dlon;
+   grid->nlon = nlon;
+   grid->lon1 = lon0 + dlon*(nlon-1);
+   grid->owngrid = 1;
+
+   if( nlat < 2 || nlon < 2 ) {
+      strcpy( grid->errmsg, "Grid must have at least two rows and columns");
+      return grid;
+      }
+
+   grid->grid = (float **) malloc( nlat * sizeof(float *) );
+   grid->data = (float *) calloc( (size_t) nlat * nlon * 2, sizeof(float) );
+   if( ! grid->grid || ! grid->data ) {
+      strcpy( grid->errmsg, notalloc );
+      if( grid->grid ) free( grid->grid );
+      if( grid->data ) free( grid->data );
+      grid->grid = NULL;
+      grid->data = NULL;
+      return grid;
+      }
+
+   for( nlt = 0; nlt < nlat; nlt++ ) {
+      grid->grid[nlt] = grid->data + (size_t) nlt * nlon * 2;
+      }
+
+   grid->gridok = 1;
+   return grid;
+   }
+
 /***********************************************************************
 *   lnzGridDestroy 
 *
@@ -217,17 +474,51 @@ void lnzGridDestroy( lnzGrid *grid ){
 
    /* If the grid data has been allocated, the release this memory */
 
+   if( grid->release ) {
+       grid->release( grid );
+       grid->release = NULL;
+       }
    if( grid->grid && grid->owngrid ) {
-       for( f = grid->grid, nf = grid->nlat; nf; nf--, f++ ) {
-          if( *f ) { free(*f); *f = NULL; }
+       if( grid->data ) {
+          free(grid->data);
+          grid->data = NULL;
+          }
+       else {
+          for( f = grid->grid, nf = grid->nlat; nf; nf--, f++ ) {
+             if( *f ) { free(*f); *f = NULL; }
+             }
           }
        free(grid->grid);
        grid->grid = NULL;
        }
+   if( grid->coverage ) {
+       free( grid->coverage );
+       grid->coverage = NULL;
+       }
    grid->gridok = 0;
    strcpy( grid->errmsg, "Grid deallocated");
    }
 
+/***********************************************************************
+*  lnzGridAddRef, lnzGridRelease
+*
+*  Functions to manage the reference count of a shared grid.
+***********************************************************************
+*/
+
+lnzGrid *lnzGridAddRef( lnzGrid *grid ){
+   if( grid ) LNZ_ATOMIC_INC( &(grid->refcount) );
+   return grid;
+   }
+
+void lnzGridRelease( lnzGrid *grid ){
+   if( ! grid ) return;
+   if( LNZ_ATOMIC_DEC( &(grid->refcount) ) == 0 ) {
+      lnzGridDestroy( grid );
+      free( grid );
+      }
+   }
+
 /***********************************************************************
 *  lnzGridIsOk
 *
@@ -272,16 +563,36 @@ char *lnzGridDatum( lnzGrid *grid, int reverse ){
    }
 
 /***********************************************************************
-*  lnzGridCalcOffset
+*  lnzGridCellIndex, lnzGridCellOffset, lnzGridCalcOffset
 *
 *  Calculates the latitude and longitude offset at a specified point on the
 *  grid.  Assumes that the point is within the range defined for the grid.
+*  lnzGridCellIndex finds the row and column of the grid cell containing
+*  the point, and lnzGridCellOffset interpolates the offset within that 
+*  cell, so that the batch functions can find the cells of a chunk of 
+*  points before interpolating them.  lnzGridCalcOffset does both.
 ***********************************************************************
 */
-   
-static void lnzGridCalcOffset( lnzGrid *grid, double lts, double lns, 
-                                 double *ltshift, double *lnshift ) {
+
+static void lnzGridCellIndex( lnzGrid *grid, double lts, double lns,
+                              int *pnlt, int *pnln ) {
    int nlt, nln;
+
+   nlt = floor( (lts - grid->lat0)/grid->dlat );
+   if( nlt < 0 ) nlt = 0;
+   if( nlt >= grid->nlat-1 ) nlt = grid->nlat-2;
+
+   nln = floor( (lns - grid->lon0)/grid->dlon );
+   if( nln < 0 ) nln = 0;
+   if( nln >= grid->nlon-1 ) nln = grid->nlon-2;
+
+   *pnlt = nlt;
+   *pnln = nln;
+   }
+
+static void lnzGridCellOffset( lnzGrid *grid, int nlt, int nln,
+                               double lts, double lns, 
+                               double *ltshift, double *lnshift ) {
    double lat0;
    double lon0;
    double dlat;
@@ -293,15 +604,9 @@ static void lnzGridCalcOffset( lnzGrid *grid, double lts, double lns,
    float *f;
 
    dlat = grid->dlat;
-   nlt = floor( (lts - grid->lat0)/dlat );
-   if( nlt < 0 ) nlt = 0;
-   if( nlt >= grid->nlat-1 ) nlt = grid->nlat-2;
    lat0 = (lts - (grid->lat0 + dlat * nlt))/dlat;
 
    dlon = grid->dlon;
-   nln = floor( (lns - grid->lon0)/dlon );
-   if( nln < 0 ) nln = 0;
-   if( nln >= grid->nlon-1 ) nln = grid->nlon-2;
    lon0 = (lns - (grid->lon0 + dlon * nln))/dlon;
 
    f = grid->grid[nlt] + nln*2;
@@ -316,6 +621,190 @@ static void lnzGridCalcOffset( lnzGrid *grid, double lts, double lns,
    *lnshift = shln0*(1-lat0) + shln1*lat0; 
    }
 
+static void lnzGridCalcOffset( lnzGrid *grid, double lts, double lns, 
+                                 double *ltshift, double *lnshift ) {
+   int nlt, nln;
+   lnzGridCellIndex( grid, lts, lns, &nlt, &nln );
+   lnzGridCellOffset( grid, nlt, nln, lts, lns, ltshift, lnshift );
+   }
+
+
+/***********************************************************************
+*  lnzGridShift
+*
+*  Public version of lnzGridCalcOffset, used for resampling grids.
+***********************************************************************
+*/
+
+void lnzGridShift( lnzGrid *grid, double lts, double lns, 
+                   double *ltshift, double *lnshift ) {
+   lnzGridCalcOffset( grid, lts, lns, ltshift, lnshift );
+   }
+
+/***********************************************************************
+*  lnzGridShiftDistance
+*
+*  Converts a shift difference to metres using a spherical approximation
+*  with the GRS80 semi-major axis.  This is only used for reporting
+*  errors, so the approximation is adequate.
+***********************************************************************
+*/
+
+#define DEG2M (6378137.0*3.14159265358979323846/180.0)
+
+double lnzGridShiftDistance( double lat, double dlt, double dln ) {
+   double dn = dlt*DEG2M;
+   double de = dln*DEG2M*cos(lat*(3.14159265358979323846/180.0));
+   return sqrt( dn*dn + de*de );
+   }
+
+/***********************************************************************
+*  lnzGridCellCovered
+*
+*  Tests the coverage bitmap to see whether the grid cell in row nlt,
+*  column nln (see lnzGridCellIndex) has data.  Assumes that the grid 
+*  has a coverage bitmap.
+***********************************************************************
+*/
+
+static int lnzGridCellCovered( lnzGrid *grid, int nlt, int nln ) {
+   int cell;
+
+   cell = nlt*(grid->nlon-1) + nln;
+   return (grid->coverage[cell >> 3] >> (cell & 7)) & 1;
+   }
+
+/***********************************************************************
+*  lnzGridApplyOffset
+*
+*  Applies the forward or reverse grid offset to a point.  Assumes that 
+*  the point has already been checked to be within the grid, and that 
+*  nlt, nln is the grid cell containing it (see lnzGridCellIndex).
+***********************************************************************
+*/
+
+static void lnzGridApplyOffset( lnzGrid *grid, int nlt, int nln, 
+                                double lts, double lns,
+                                double *ltd, double *lnd, int reverse ) {
+   double dlat, dlon, ltt, lnt;
+
+   lnzGridCellOffset( grid, nlt, nln, lts, lns, &dlat, &dlon );
+   
+   if( ! reverse ) {
+       lts += dlat; 
+       lns += dlon;
+       }
+   else {
+       /* For the reverse transformation just iterate once - should be
+          enough for any sensible grid */
+       ltt = lts - dlat;
+       lnt = lns - dlon;
+       lnzGridCalcOffset( grid, ltt, lnt, &dlat, &dlon );
+       lts = lts - dlat;
+       lns = lns - dlon;
+       }
+
+   *ltd = lts;
+   *lnd = lns;
+   }
+
+/***********************************************************************
+*  lnzGridCellOffsetDeriv, lnzGridCalcOffsetDeriv
+*
+*  As for lnzGridCellOffset and lnzGridCalcOffset, but also calculate the
+*  derivatives of the bilinear interpolated shifts with respect to 
+*  latitude and longitude.  These are returned in d as d(ltshift)/dlat,
+*  d(ltshift)/dlon, d(lnshift)/dlat, d(lnshift)/dlon.
+***********************************************************************
+*/
+   
+static void lnzGridCellOffsetDeriv( lnzGrid *grid, int nlt, int nln,
+                                    double lts, double lns, 
+                                    double *ltshift, double *lnshift,
+                                    double *d ) {
+   double lat0;
+   double lon0;
+   double dlat;
+   double dlon;
+   double shlt0;
+   double shln0;
+   double shlt1;
+   double shln1;
+   float *f0;
+   float *f1;
+
+   dlat = grid->dlat;
+   lat0 = (lts - (grid->lat0 + dlat * nlt))/dlat;
+
+   dlon = grid->dlon;
+   lon0 = (lns - (grid->lon0 + dlon * nln))/dlon;
+
+   f0 = grid->grid[nlt] + nln*2;
+   shlt0 = f0[0]*(1-lon0) + f0[2]*lon0;
+   shln0 = f0[1]*(1-lon0) + f0[3]*lon0;
+
+   f1 = grid->grid[nlt+1] + nln*2;
+   shlt1 = f1[0]*(1-lon0) + f1[2]*lon0;
+   shln1 = f1[1]*(1-lon0) + f1[3]*lon0;
+
+   *ltshift = shlt0*(1-lat0) + shlt1*lat0;
+   *lnshift = shln0*(1-lat0) + shln1*lat0; 
+
+   d[0] = (shlt1 - shlt0)/dlat;
+   d[1] = ((f0[2]-f0[0])*(1-lat0) + (f1[2]-f1[0])*lat0)/dlon;
+   d[2] = (shln1 - shln0)/dlat;
+   d[3] = ((f0[3]-f0[1])*(1-lat0) + (f1[3]-f1[1])*lat0)/dlon;
+   }
+
+static void lnzGridCalcOffsetDeriv( lnzGrid *grid, double lts, double lns, 
+                                    double *ltshift, double *lnshift,
+                                    double *d ) {
+   int nlt, nln;
+   lnzGridCellIndex( grid, lts, lns, &nlt, &nln );
+   lnzGridCellOffsetDeriv( grid, nlt, nln, lts, lns, ltshift, lnshift, d );
+   }
+
+/***********************************************************************
+*  lnzGridApplyJacobian
+*
+*  As for lnzGridApplyOffset, but also returns the Jacobian of the 
+*  output coordinates with respect to the input coordinates.  For the
+*  reverse transformation this is the derivative of the single iteration
+*  actually applied, that is  I - S'(p1)(I - S'(p0)), where S' is the 
+*  derivative of the shift, p0 the input point, and p1 the first
+*  estimate of the output.
+***********************************************************************
+*/
+
+static void lnzGridApplyJacobian( lnzGrid *grid, int nlt, int nln,
+                                  double lts, double lns,
+                                  double *ltd, double *lnd, double *jac,
+                                  int reverse ) {
+   double dlat, dlon, ltt, lnt;
+   double d0[4], d1[4];
+
+   lnzGridCellOffsetDeriv( grid, nlt, nln, lts, lns, &dlat, &dlon, d0 );
+   
+   if( ! reverse ) {
+       *ltd = lts + dlat; 
+       *lnd = lns + dlon;
+       jac[0] = 1.0 + d0[0];
+       jac[1] = d0[1];
+       jac[2] = d0[2];
+       jac[3] = 1.0 + d0[3];
+       }
+   else {
+       ltt = lts - dlat;
+       lnt = lns - dlon;
+       lnzGridCalcOffsetDeriv( grid, ltt, lnt, &dlat, &dlon, d1 );
+       *ltd = lts - dlat;
+       *lnd = lns - dlon;
+       jac[0] = 1.0 - (d1[0]*(1.0-d0[0]) - d1[1]*d0[2]);
+       jac[1] = -(d1[1]*(1.0-d0[3]) - d1[0]*d0[1]);
+       jac[2] = -(d1[2]*(1.0-d0[0]) - d1[3]*d0[2]);
+       jac[3] = 1.0 - (d1[3]*(1.0-d0[3]) - d1[2]*d0[1]);
+       }
+   }
 
 /***********************************************************************
 *  lnzGridTransform
@@ -333,7 +822,8 @@ static void lnzGridCalcOffset( lnzGrid *grid, double lts, double lns,
 */
 
 int lnzGridTransform( lnzGrid *grid, double lts, double lns, double *ltd, double *lnd, int reverse ){
-   double dlat, dlon, ltt, lnt;
+
+   int nlt, nln;
 
    /* Check that the grid is valid */
    if( ! grid || ! grid->gridok ) return 0;
@@ -350,24 +840,17 @@ int lnzGridTransform( lnzGrid *grid, double lts, double lns, double *ltd, double
       strcpy( grid->errmsg, "Point is outside the range of the grid");
       return 0;
       }
+
+   lnzGridCellIndex( grid, lts, lns, &nlt, &nln );
+
+   if( grid->coverage && ! lnzGridCellCovered( grid, nlt, nln ) ) {
+      strcpy( grid->errmsg, "Point is in a part of the grid without data");
+      return 0;
+      }
    
    /* Now do the calculation */
 
-   lnzGridCalcOffset( grid, lts, lns, &dlat, &dlon );
-   
-   if( ! reverse ) {
-       lts += dlat; 
-       lns += dlon;
-       }
-   else {
-       /* For the reverse transformation just iterate once - should be
-          enough for any sensible grid */
-       ltt = lts - dlat;
-       lnt = lns - dlon;
-       lnzGridCalcOffset( grid, ltt, lnt, &dlat, &dlon );
-       lts = lts - dlat;
-       lns = lns - dlon;
-       }
+   lnzGridApplyOffset( grid, nlt, nln, lts, lns, &lts, &lns, reverse );
 
    /* Return the results */
 
@@ -377,6 +860,476 @@ int lnzGridTransform( lnzGrid *grid, double lts, double lns, double *ltd, double
    return 1;
    }
 
+/***********************************************************************
+*  lnzGridSetNoData
+*
+*  Builds the coverage bitmap of the grid.  Each bit represents one grid
+*  cell (ordered by latitude then longitude), and is set if all four 
+*  corner nodes of the cell have data.  Nodes are missing if either 
+*  shift matches the nodata value (in seconds of arc, as in the grid
+*  file).  Returns the number of cells with data, or -1 if the bitmap
+*  could not be created.
+***********************************************************************
+*/
+
+#define NODATA_TOL 1.0e-4
+
+static int lnzGridNodeOk( lnzGrid *grid, int nlt, int nln, double nodata ) {
+   float *f = grid->grid[nlt] + nln*2;
+   double shlt = f[0]*3600.0;
+   double shln = -f[1]*3600.0;
+
+   if( shlt != shlt || shln != shln ) return 0;
+   if( fabs(shlt - nodata) < NODATA_TOL ) return 0;
+   if( fabs(shln - nodata) < NODATA_TOL ) return 0;
+   return 1;
+   }
+
+int lnzGridSetNoData( lnzGrid *grid, double nodata ){
+   unsigned char *cov;
+   int nlt, nln, ncell, ncov, cell;
+
+   if( ! grid || ! grid->gridok ) return -1;
+
+   ncell = (grid->nlat-1)*(grid->nlon-1);
+   cov = (unsigned char *) calloc( (ncell+7)/8, 1 );
+   if( ! cov ) {
+      strcpy( grid->errmsg, notalloc );
+      return -1;
+      }
+
+   ncov = 0;
+   for( nlt = 0; nlt < grid->nlat-1; nlt++ ) {
+      for( nln = 0; nln < grid->nlon-1; nln++ ) {
+         if( lnzGridNodeOk( grid, nlt, nln, nodata ) &&
+             lnzGridNodeOk( grid, nlt, nln+1, nodata ) &&
+             lnzGridNodeOk( grid, nlt+1, nln, nodata ) &&
+             lnzGridNodeOk( grid, nlt+1, nln+1, nodata ) ) {
+            cell = nlt*(grid->nlon-1) + nln;
+            cov[cell >> 3] |= (unsigned char) (1 << (cell & 7));
+            ncov++;
+            }
+         }
+      }
+
+   /* If every cell has data then the bitmap is not needed */
+
+   if( ncov == ncell ) { free(cov); cov = NULL; }
+
+   if( grid->coverage ) free( grid->coverage );
+   grid->coverage = cov;
+
+   return ncov;
+   }
+
+/***********************************************************************
+*  lnzGridSetHelmertFallback
+*
+*  Sets the 7 parameter transformation used by the batch transformation
+*  for points that cannot be transformed using the grid.
+***********************************************************************
+*/
+
+#define DTOR (3.14159265358979323846/180.0)
+#define SEC2RAD (DTOR/3600.0)
+
+static lnzHelmert nzgd49helmert = {
+   6378388.0, 297.0,
+   6378137.0, 298.257222101,
+   59.47, -5.04, 187.44,
+   0.47, -0.1, 1.024,
+   -4.5993 };
+
+const lnzHelmert *lnzGridHelmertNzgd49( void ){
+   return &nzgd49helmert;
+   }
+
+void lnzGridSetHelmertFallback( lnzGrid *grid, const lnzHelmert *hlm,
+                                double margin ){
+   if( ! grid ) return;
+   if( ! hlm ) {
+      grid->usefallback = 0;
+      return;
+      }
+   grid->fallback = *hlm;
+   grid->fbmargin = margin;
+   grid->usefallback = 1;
+   }
+
+/***********************************************************************
+*  lnzHelmertSetup, lnzHelmertApply
+*
+*  Functions to apply the Helmert transformation.  lnzHelmertSetup
+*  converts the parameters to the form used in the calculation for
+*  either the forward or reverse direction.  lnzHelmertApply converts 
+*  a latitude and longitude (degrees) to geocentric XYZ, applies the 
+*  transformation, and converts back using Bowring's formula.  The 
+*  output longitude is returned on the same branch as the input.
+***********************************************************************
+*/
+
+typedef struct {
+   double a0, e20;
+   double a1, e21;
+   double tx, ty, tz;
+   double rx, ry, rz;
+   double sc;
+   } lnzHelmertCalc;
+
+static void lnzHelmertSetup( const lnzHelmert *hlm, int reverse,
+                             lnzHelmertCalc *hc ) {
+   double sign = reverse ? -1.0 : 1.0;
+   double f0 = hlm->rf0 != 0.0 ? 1.0/hlm->rf0 : 0.0;
+   double f1 = hlm->rf1 != 0.0 ? 1.0/hlm->rf1 : 0.0;
+
+   if( ! reverse ) {
+      hc->a0 = hlm->a0; hc->e20 = 2.0*f0 - f0*f0;
+      hc->a1 = hlm->a1; hc->e21 = 2.0*f1 - f1*f1;
+      }
+   else {
+      hc->a0 = hlm->a1; hc->e20 = 2.0*f1 - f1*f1;
+      hc->a1 = hlm->a0; hc->e21 = 2.0*f0 - f0*f0;
+      }
+   hc->tx = sign*hlm->tx;
+   hc->ty = sign*hlm->ty;
+   hc->tz = sign*hlm->tz;
+   hc->rx = sign*hlm->rx*SEC2RAD;
+   hc->ry = sign*hlm->ry*SEC2RAD;
+   hc->rz = sign*hlm->rz*SEC2RAD;
+   hc->sc = 1.0 + sign*hlm->ds*1.0e-6;
+   }
+
+static void lnzHelmertApply( const lnzHelmertCalc *hc, double lts, double lns,
+                             double *ltd, double *lnd ) {
+   double lt, ln, slt, clt, nu, x, y, z, x1, y1, z1;
+   double p, b, ep2, th, sth, cth, lt1, ln1, dln;
+
+   lt = lts*DTOR;
+   ln = lns*DTOR;
+   slt = sin(lt);
+   clt = cos(lt);
+   nu = hc->a0/sqrt(1.0 - hc->e20*slt*slt);
+   x = nu*clt*cos(ln);
+   y = nu*clt*sin(ln);
+   z = nu*(1.0 - hc->e20)*slt;
+
+   x1 = hc->tx + hc->sc*(x - hc->rz*y + hc->ry*z);
+   y1 = hc->ty + hc->sc*(hc->rz*x + y - hc->rx*z);
+   z1 = hc->tz + hc->sc*(-hc->ry*x + hc->rx*y + z);
+
+   p = sqrt(x1*x1 + y1*y1);
+   b = hc->a1*sqrt(1.0 - hc->e21);
+   ep2 = hc->e21/(1.0 - hc->e21);
+   th = atan2( z1*hc->a1, p*b );
+   sth = sin(th);
+   cth = cos(th);
+   lt1 = atan2( z1 + ep2*b*sth*sth*sth, p - hc->e21*hc->a1*cth*cth*cth );
+   ln1 = atan2( y1, x1 );
+
+   dln = (ln1 - ln)/DTOR;
+   dln -= 360.0 * floor( (dln + 180.0)/360.0 );
+
+   *ltd = lt1/DTOR;
+   *lnd = lns + dln;
+   }
+
+/***********************************************************************
+*  lnzGridBatchFallback
+*
+*  Applies the Helmert fallback to points of a batch that were not 
+*  transformed using the grid, and are within the fallback margin of the
+*  grid.  Updates the mask with the status of these points.
+***********************************************************************
+*/
+
+static int lnzGridBatchFallback( lnzGrid *grid, const lnzHelmertCalc *hc,
+                                 int npt, const double *lts, const double *lns,
+                                 double *ltd, double *lnd, unsigned char *mask ) {
+   double margin = grid->fbmargin;
+   double lat0 = grid->lat0 - margin;
+   double lat1 = grid->lat1 + margin;
+   double lon0 = grid->lon0 - margin;
+   double lon1 = grid->lon1 + margin;
+   int i, nfb;
+
+   nfb = 0;
+   for( i = 0; i < npt; i++ ) {
+      double lt, ln;
+      if( mask[i] != LNZGRID_PT_OUTSIDE ) continue;
+      lt = lts[i];
+      ln = lns[i];
+      if( lt != lt || ln != ln ) continue;
+      if( margin >= 0.0 ) {
+         ln -= 360.0 * floor( (ln - grid->lon0)/360.0 );
+         if( lt < lat0 || lt > lat1 ) continue;
+         if( ln > lon1 && ln - 360.0 < lon0 ) continue;
+         }
+      lnzHelmertApply( hc, lts[i], lns[i], ltd+i, lnd+i );
+      mask[i] = LNZGRID_PT_HELMERT;
+      nfb++;
+      }
+   return nfb;
+   }
+
+/***********************************************************************
+*  lnzGridTransformBatch
+*
+*  Transforms an array of points.  If the bounding box of the points is
+*  within the grid, and the grid has no missing data, then the points are
+*  transformed without further checks.  Otherwise a mask of valid 
+*  points is built for each chunk (wrapping longitudes and testing the
+*  coverage bitmap without branching), then all points are calculated 
+*  and the mask used to select the results.  In either case the points
+*  are calculated in chunks, prefetching the grid cells of upcoming 
+*  points (see lnzGridBatchChunk).  Points that
+*  are not valid are calculated at the grid origin, so that the 
+*  calculation is always safe.  Finally the Helmert fallback, if it is
+*  defined, is applied to the points that were not valid.
+***********************************************************************
+*/
+
+#define LNZGRID_BATCH_CHUNK 256
+
+#if defined(__GNUC__)
+#define LNZGRID_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define LNZGRID_PREFETCH(p) _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#else
+#define LNZGRID_PREFETCH(p)
+#endif
+
+/***********************************************************************
+*  lnzGridBatchCells
+*
+*  The first sweep over a chunk of points, which finds the row and 
+*  column of the grid cell containing each point, as lnzGridCellIndex.
+*  The points must be within the grid.  The cells of the first points 
+*  are prefetched here, and the rest while the points before them are 
+*  interpolated.
+***********************************************************************
+*/
+
+static void lnzGridBatchCells( lnzGrid *grid, int npt, const double *lts,
+                               const double *lns, int distance,
+                               int *row, int *col ) {
+   double lat0 = grid->lat0;
+   double lon0 = grid->lon0;
+   double dlat = grid->dlat;
+   double dlon = grid->dlon;
+   int i, nlt, nln;
+
+   for( i = 0; i < npt; i++ ) {
+      nlt = (int) floor( (lts[i] - lat0)/dlat );
+      nln = (int) floor( (lns[i] - lon0)/dlon );
+      row[i] = nlt < 0 ? 0 : nlt >= grid->nlat-1 ? grid->nlat-2 : nlt;
+      col[i] = nln < 0 ? 0 : nln >= grid->nlon-1 ? grid->nlon-2 : nln;
+      }
+
+   for( i = 0; i < distance && i < npt; i++ ) {
+      LNZGRID_PREFETCH( grid->grid[row[i]] + col[i]*2 );
+      LNZGRID_PREFETCH( grid->grid[row[i]+1] + col[i]*2 );
+      }
+   }
+
+/***********************************************************************
+*  lnzGridBatchChunk
+*
+*  The second sweep over a chunk, which transforms each point in the 
+*  cell found by the first sweep, while prefetching the cells of the 
+*  point distance ahead.
+***********************************************************************
+*/
+
+static void lnzGridBatchChunk( lnzGrid *grid, int npt, const double *lts,
+                               const double *lns, double *ltd, double *lnd,
+                               double *jac, int reverse ) {
+   int row[LNZGRID_BATCH_CHUNK];
+   int col[LNZGRID_BATCH_CHUNK];
+   int distance = grid->prefetch ? grid->prefetch : LNZGRID_PREFETCH_DISTANCE;
+   int i;
+
+   lnzGridBatchCells( grid, npt, lts, lns, distance, row, col );
+
+   for( i = 0; i < npt; i++ ) {
+      if( distance > 0 && i + distance < npt ) {
+         LNZGRID_PREFETCH( grid->grid[row[i+distance]] + col[i+distance]*2 );
+         LNZGRID_PREFETCH( grid->grid[row[i+distance]+1] + col[i+distance]*2 );
+         }
+      if( jac ) {
+         lnzGridApplyJacobian( grid, row[i], col[i], lts[i], lns[i], 
+                               ltd+i, lnd+i, jac+4*i, reverse );
+         }
+      else {
+         lnzGridApplyOffset( grid, row[i], col[i], lts[i], lns[i], 
+                             ltd+i, lnd+i, reverse );
+         }
+      }
+   }
+
+static int lnzGridBatchMask( lnzGrid *grid, int npt, const double *lts,
+                             const double *lns, double *ltc, double *lnc,
+                             unsigned char *mask ) {
+   double lat0 = grid->lat0;
+   double lat1 = grid->lat1;
+   double lon0 = grid->lon0;
+   double lon1 = grid->lon1;
+   int i, nok;
+
+   for( i = 0; i < npt; i++ ) {
+      double lt = lts[i];
+      double ln = lns[i];
+      int ok;
+      ln -= 360.0 * floor( (ln - lon0)/360.0 );
+      ok = (lt >= lat0) & (lt <= lat1) & (ln <= lon1);
+      ltc[i] = ok ? lt : lat0;
+      lnc[i] = ok ? ln : lon0;
+      mask[i] = ok ? LNZGRID_PT_GRID : LNZGRID_PT_OUTSIDE;
+      }
+
+   if( grid->coverage ) {
+      for( i = 0; i < npt; i++ ) {
+         int nlt, nln;
+         lnzGridCellIndex( grid, ltc[i], lnc[i], &nlt, &nln );
+         mask[i] &= (unsigned char) lnzGridCellCovered( grid, nlt, nln );
+         }
+      }
+
+   nok = 0;
+   for( i = 0; i < npt; i++ ) nok += mask[i] == LNZGRID_PT_GRID;
+   return nok;
+   }
+
+static void lnzGridSetIdentity( double *jac ) {
+   jac[0] = 1.0; jac[1] = 0.0;
+   jac[2] = 0.0; jac[3] = 1.0;
+   }
+
+static int lnzGridBatch( lnzGrid *grid, int npt,
+                         const double *lts, const double *lns,
+                         double *ltd, double *lnd, double *jac,
+                         int reverse, unsigned char *status ){
+   unsigned char mask[LNZGRID_BATCH_CHUNK];
+   lnzHelmertCalc hc;
+   double ltc[LNZGRID_BATCH_CHUNK];
+   double lnc[LNZGRID_BATCH_CHUNK];
+   double ltt[LNZGRID_BATCH_CHUNK];
+   double lnt[LNZGRID_BATCH_CHUNK];
+   double ltmin, ltmax, lnmin, lnmax;
+   int hasnan;
+   int i, n, nc, nok;
+
+   if( npt <= 0 ) return 0;
+
+   if( ! grid || ! grid->gridok ) {
+      for( i = 0; i < npt; i++ ) { ltd[i] = lts[i]; lnd[i] = lns[i]; }
+      if( jac ) for( i = 0; i < npt; i++ ) lnzGridSetIdentity( jac+4*i );
+      if( status ) memset( status, LNZGRID_PT_OUTSIDE, npt );
+      return 0;
+      }
+
+   /* Find the bounding box of the batch */
+
+   ltmin = ltmax = lts[0];
+   lnmin = lnmax = lns[0];
+   hasnan = 0;
+   for( i = 0; i < npt; i++ ) {
+      double lt = lts[i];
+      double ln = lns[i];
+      ltmin = lt < ltmin ? lt : ltmin;
+      ltmax = lt > ltmax ? lt : ltmax;
+      lnmin = ln < lnmin ? ln : lnmin;
+      lnmax = ln > lnmax ? ln : lnmax;
+      hasnan |= (lt != lt) | (ln != ln);
+      }
+
+   /* If the whole batch is inside the grid no further checks are needed */
+
+   if( ! hasnan && ! grid->coverage &&
+       ltmin >= grid->lat0 && ltmax <= grid->lat1 &&
+       lnmin >= grid->lon0 && lnmax <= grid->lon1 ) {
+      for( n = 0; n < npt; n += nc ) {
+         nc = npt - n;
+         if( nc > LNZGRID_BATCH_CHUNK ) nc = LNZGRID_BATCH_CHUNK;
+         lnzGridBatchChunk( grid, nc, lts+n, lns+n, ltd+n, lnd+n, 
+                            jac ? jac+4*n : NULL, reverse );
+         }
+      if( status ) memset( status, LNZGRID_PT_GRID, npt );
+      return npt;
+      }
+
+   /* Otherwise build and apply a mask of valid points */
+
+   memset( &hc, 0, sizeof(hc) );
+   if( grid->usefallback ) lnzHelmertSetup( &grid->fallback, reverse, &hc );
+
+   nok = 0;
+   for( n = 0; n < npt; n += nc ) {
+      nc = npt - n;
+      if( nc > LNZGRID_BATCH_CHUNK ) nc = LNZGRID_BATCH_CHUNK;
+
+      nok += lnzGridBatchMask( grid, nc, lts+n, lns+n, ltc, lnc, mask );
+
+      lnzGridBatchChunk( grid, nc, ltc, lnc, ltt, lnt, 
+                         jac ? jac+4*n : NULL, reverse );
+
+      for( i = 0; i < nc; i++ ) {
+         if( jac ) {
+            double *jc = jac + 4*(n+i);
+            jc[0] = mask[i] ? jc[0] : 1.0;
+            jc[1] = mask[i] ? jc[1] : 0.0;
+            jc[2] = mask[i] ? jc[2] : 0.0;
+            jc[3] = mask[i] ? jc[3] : 1.0;
+            }
+         ltd[n+i] = mask[i] ? ltt[i] : lts[n+i];
+         lnd[n+i] = mask[i] ? lnt[i] : lns[n+i];
+         }
+
+      if( grid->usefallback && nok < n+nc ) {
+         nok += lnzGridBatchFallback( grid, &hc, nc, lts+n, lns+n,
+                                      ltd+n, lnd+n, mask );
+         }
+
+      if( status ) memcpy( status+n, mask, nc );
+      }
+
+   return nok;
+   }
+
+int lnzGridTransformBatch( lnzGrid *grid, int npt,
+                           const double *lts, const double *lns,
+                           double *ltd, double *lnd, int reverse,
+                           unsigned char *status ){
+   return lnzGridBatch( grid, npt, lts, lns, ltd, lnd, NULL, reverse, status );
+   }
+
+/***********************************************************************
+*  lnzGridTransformJacobian
+*
+*  As for lnzGridTransformBatch, but also returns the Jacobian of the
+*  transformation at each point, calculated analytically from the same
+*  grid cell values as the shift.  
+***********************************************************************
+*/
+
+int lnzGridTransformJacobian( lnzGrid *grid, int npt,
+                              const double *lts, const double *lns,
+                              double *ltd, double *lnd, double *jac,
+                              int reverse, unsigned char *status ){
+   return lnzGridBatch( grid, npt, lts, lns, ltd, lnd, jac, reverse, status );
+   }
+
+/***********************************************************************
+*  lnzGridSetPrefetch
+***********************************************************************
+*/
+
+void lnzGridSetPrefetch( lnzGrid *grid, int distance ){
+   if( ! grid ) return;
+   if( distance > LNZGRID_BATCH_CHUNK ) distance = LNZGRID_BATCH_CHUNK;
+   grid->prefetch = distance;
+   }
+
 #ifdef __cplusplus
 };
 #endif
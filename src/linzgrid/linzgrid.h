@@ -40,6 +40,8 @@
 ***********************************************************************
 */
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -49,7 +51,25 @@ extern "C" {
 #define MAX_ERRMSG_LEN 80
 #define MAX_DATUM_LEN  16
 
+/* Parameters of a 7 parameter similarity (Helmert) transformation, 
+   applied through geocentric XYZ coordinates.  Rotations use the 
+   position vector convention */
+
 typedef struct {
+   double a0;      /* Semi-major axis of the source ellipsoid */
+   double rf0;     /* Inverse flattening of the source ellipsoid */
+   double a1;      /* Semi-major axis of the target ellipsoid */
+   double rf1;     /* Inverse flattening of the target ellipsoid */
+   double tx;      /* X translation (metres) */
+   double ty;      /* Y translation (metres) */
+   double tz;      /* Z translation (metres) */
+   double rx;      /* X rotation (seconds of arc) */
+   double ry;      /* Y rotation (seconds of arc) */
+   double rz;      /* Z rotation (seconds of arc) */
+   double ds;      /* Scale change (parts per million) */
+} lnzHelmert;
+
+typedef struct lnzGridStruct {
    double lat0;    /* The minimum latitude */
    double lat1;    /* The maximum latitude */
    double dlat;    /* The latitude increment */
@@ -64,15 +84,59 @@ typedef struct {
    char datum1[MAX_DATUM_LEN];  /* The target datum for the transformation */
    char errmsg[MAX_ERRMSG_LEN]; /* The last error message recorded */
    float **grid;   /* The grid data */
+   unsigned char *coverage; /* Packed bitmap of grid cells that have data,
+                               or NULL if every cell has data */
+   int usefallback;         /* Flags whether the Helmert fallback is used */
+   double fbmargin;         /* Distance outside the grid (degrees) within 
+                               which the fallback is applied */
+   lnzHelmert fallback;     /* The fallback transformation */
+   float *data;             /* The grid data as a single block, if it was 
+                               allocated that way */
+   long refcount;           /* The number of references held with 
+                               lnzGridAddRef */
+   void *mapping;           /* Memory mapping holding the grid data, if any */
+   size_t maplen;           /* The length of the memory mapping */
+   void (*release)( struct lnzGridStruct *grid );
+                            /* Function used by lnzGridDestroy to release
+                               grid data not allocated with malloc */
+   int hugepages;           /* Whether the grid data is backed by huge 
+                               pages (LNZGRID_HUGE_...) */
+   int prefetch;            /* Prefetch distance (points) for batch 
+                               transformations, 0 for the default, 
+                               negative for none */
 } lnzGrid;
 
+/* Status codes returned for each point by lnzGridTransformBatch */
+
+#define LNZGRID_PT_OUTSIDE  0  /* Point not transformed - outside the grid */
+#define LNZGRID_PT_GRID     1  /* Point transformed using the grid */
+#define LNZGRID_PT_HELMERT  2  /* Point transformed by the Helmert fallback */
+
+/* Default prefetch distance for batch transformations */
+
+#define LNZGRID_PREFETCH_DISTANCE 16
+
+/* Huge page backing of grid data, see linzgridhuge.c */
+
+#define LNZGRID_HUGE_NONE   0  /* Grid data uses normal pages */
+#define LNZGRID_HUGE_TLB    1  /* Grid data is in reserved huge pages */
+#define LNZGRID_HUGE_THP    2  /* Transparent huge pages requested for 
+                                  the grid data */
+
 
 /* Functions to manage the grid and transform coordinates.  See the comments
    in the source code file linzgrid.c for details of these functions
 */
 
+lnzGrid *lnzGridCreate( double lat0, double dlat, int nlat,
+                        double lon0, double dlon, int nlon );
+
 void     lnzGridDestroy( lnzGrid *grid );
 
+lnzGrid *lnzGridAddRef( lnzGrid *grid );
+
+void     lnzGridRelease( lnzGrid *grid );
+
 int      lnzGridIsOk( lnzGrid *grid );
 
 char *   lnzGridLastError( lnzGrid *grid );
@@ -82,6 +146,30 @@ char *    lnzGridDatum( lnzGrid *grid, int reverse );
 int      lnzGridTransform( lnzGrid *grid, double lts, double lns, 
                            double *ltd, double *lnd, int reverse );
 
+void     lnzGridShift( lnzGrid *grid, double lts, double lns,
+                           double *ltshift, double *lnshift );
+
+double   lnzGridShiftDistance( double lat, double dlt, double dln );
+
+int      lnzGridSetNoData( lnzGrid *grid, double nodata );
+
+void     lnzGridSetHelmertFallback( lnzGrid *grid, const lnzHelmert *hlm,
+                           double margin );
+
+const lnzHelmert * lnzGridHelmertNzgd49( void );
+
+void     lnzGridSetPrefetch( lnzGrid *grid, int distance );
+
+int      lnzGridTransformBatch( lnzGrid *grid, int npt,
+                           const double *lts, const double *lns,
+                           double *ltd, double *lnd, int reverse,
+                           unsigned char *status );
+
+int      lnzGridTransformJacobian( lnzGrid *grid, int npt,
+                           const double *lts, const double *lns,
+                           double *ltd, double *lnd, double *jac,
+                           int reverse, unsigned char *status );
+
 #ifdef __cplusplus
 };
 #endif
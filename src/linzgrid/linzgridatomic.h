@@ -0,0 +1,51 @@
+#ifndef LINZGRIDATOMIC_H
+#define LINZGRIDATOMIC_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Minimal portable atomic operations used for sharing grids between 
+*  threads.  GCC and compatible compilers use the __atomic builtins, 
+*  and Microsoft compilers the Interlocked functions (which are full
+*  barriers).  All operations are sequentially consistent, which the 
+*  hazard pointers used by grid handles (linzgridhandle.c) rely on.
+*
+*  LNZ_ATOMIC_INC(p), LNZ_ATOMIC_DEC(p)   Increment or decrement a long
+*                                         and return the new value
+*  LNZ_ATOMIC_CAS(p,e,v)                  Set long *p to v if it equals
+*                                         e, returning true if it did
+*  LNZ_ATOMIC_LOAD_PTR(p)                 Read a pointer
+*  LNZ_ATOMIC_STORE_PTR(p,v)              Write a pointer
+*  LNZ_ATOMIC_XCHG_PTR(p,v)               Write a pointer and return
+*                                         the previous value
+*
+***********************************************************************
+*/
+
+#if defined(_MSC_VER)
+
+#include <windows.h>
+
+#define LNZ_ATOMIC_INC(p)  InterlockedIncrement((volatile LONG *)(p))
+#define LNZ_ATOMIC_DEC(p)  InterlockedDecrement((volatile LONG *)(p))
+#define LNZ_ATOMIC_CAS(p,e,v) \
+   (InterlockedCompareExchange((volatile LONG *)(p),(v),(e)) == (e))
+#define LNZ_ATOMIC_LOAD_PTR(p) \
+   InterlockedCompareExchangePointer((PVOID volatile *)(p),NULL,NULL)
+#define LNZ_ATOMIC_STORE_PTR(p,v) \
+   ((void) InterlockedExchangePointer((PVOID volatile *)(p),(v)))
+#define LNZ_ATOMIC_XCHG_PTR(p,v) \
+   InterlockedExchangePointer((PVOID volatile *)(p),(v))
+
+#else
+
+#define LNZ_ATOMIC_INC(p)  __atomic_add_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define LNZ_ATOMIC_DEC(p)  __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#define LNZ_ATOMIC_CAS(p,e,v)      __sync_bool_compare_and_swap((p),(e),(v))
+#define LNZ_ATOMIC_LOAD_PTR(p)     __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define LNZ_ATOMIC_STORE_PTR(p,v)  __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define LNZ_ATOMIC_XCHG_PTR(p,v)   __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+
+#endif
+
+#endif
@@ -0,0 +1,204 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module resamples a hierarchy of grids onto a single uniform
+*  grid.  A hierarchy is a parent grid together with denser child grids
+*  covering parts of it, as defined by the subgrids of an NTv2 file.
+*  Transforming a point with a hierarchy means finding the densest grid
+*  that contains it, which costs extra branches and cache misses for
+*  every point.  The flattened grid is built at the finest spacing of
+*  the grids, restricted to an extent chosen by the caller, so that each
+*  lookup is a single index calculation.
+*
+*  The hierarchy is supplied as an array of grids ordered from the
+*  parent to the densest child.  A point takes its shift from the last
+*  grid in the array that contains it.  Grids with missing data (see
+*  lnzGridSetNoData) are not supported.
+*
+***********************************************************************
+*  This module provides the following function.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGrid *lnzGridFlatten( lnzGrid **grids, int ngrid,
+*                           double lat0, double lat1,
+*                           double lon0, double lon1,
+*                           long *size, double *maxerr );
+*
+*     Creates a single grid from a hierarchy of grids.
+*
+*     Parameters
+*        grids     The grids, ordered from parent to densest child
+*        ngrid     The number of grids
+*        lat0      The minimum latitude of the required extent
+*        lat1      The maximum latitude of the required extent
+*        lon0      The minimum longitude of the required extent
+*        lon1      The maximum longitude of the required extent
+*        size      Returns the memory used by the grid data (bytes).
+*                  May be NULL.
+*        maxerr    Returns the maximum difference (metres) between the
+*                  flattened grid and the hierarchy, sampled at the
+*                  centre and edge midpoints of each cell of the
+*                  flattened grid.  May be NULL.
+*
+*     Returns
+*        lnzGrid * The flattened grid, which should be tested with
+*                  lnzGridIsOk.  The spacing is the finest spacing of the
+*                  grids that overlap the extent, and the nodes are
+*                  aligned with the nodes of the densest of these grids.
+*                  The extent is expanded to the enclosing nodes.  If
+*                  part of the extent is not covered by any grid the
+*                  nodes there are flagged as missing, using
+*                  lnzGridSetNoData.  Returns NULL if no memory can be
+*                  allocated, including for the coverage of the
+*                  missing nodes.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "linzgridflat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+*  flatContains, flatLookup
+*
+*  Test whether a grid contains a point, and find the shift at a point
+*  from the densest grid in the hierarchy that contains it.  flatLookup
+*  returns 0 if no grid contains the point.
+***********************************************************************
+*/
+
+static int flatContains( lnzGrid *grid, double lts, double lns ) {
+   return lts >= grid->lat0 && lts <= grid->lat1 &&
+          lns >= grid->lon0 && lns <= grid->lon1;
+   }
+
+static int flatLookup( lnzGrid **grids, int ngrid, double lts, double lns,
+                       double *ltshift, double *lnshift ) {
+   int ng;
+   for( ng = ngrid; ng--; ) {
+      if( flatContains( grids[ng], lts, lns ) ) {
+         lnzGridShift( grids[ng], lts, lns, ltshift, lnshift );
+         return 1;
+         }
+      }
+   return 0;
+   }
+
+/***********************************************************************
+*  lnzGridFlatten
+***********************************************************************
+*/
+
+lnzGrid *lnzGridFlatten( lnzGrid **grids, int ngrid,
+                         double lat0, double lat1, double lon0, double lon1,
+                         long *size, double *maxerr ) {
+   lnzGrid *flat, *dense;
+   double dlat, dlon, lt, ln, shlt, shln, err, flterr;
+   int ng, nlat, nlon, nlt, nln, nmissing, i;
+   float *f;
+
+   if( size ) *size = 0;
+   if( maxerr ) *maxerr = 0.0;
+
+   /* Find the densest grid that overlaps the extent */
+
+   dense = NULL;
+   for( ng = 0; ng < ngrid; ng++ ) {
+      lnzGrid *g = grids[ng];
+      if( ! lnzGridIsOk( g ) ) continue;
+      if( g->lat0 > lat1 || g->lat1 < lat0 || g->lon0 > lon1 || g->lon1 < lon0 ) {
+         continue;
+         }
+      if( ! dense || g->dlat*g->dlon < dense->dlat*dense->dlon ) dense = g;
+      }
+
+   if( ! dense ) {
+      flat = lnzGridCreate( lat0, 0.0, 0, lon0, 0.0, 0 );
+      if( flat ) strcpy( flat->errmsg, "No grid overlaps the extent to flatten" );
+      return flat;
+      }
+
+   /* Align the extent with the nodes of the densest grid */
+
+   dlat = dense->dlat;
+   dlon = dense->dlon;
+   lat0 = dense->lat0 + floor( (lat0 - dense->lat0)/dlat + 1.0e-9 )*dlat;
+   lon0 = dense->lon0 + floor( (lon0 - dense->lon0)/dlon + 1.0e-9 )*dlon;
+   nlat = (int) ceil( (lat1 - lat0)/dlat - 1.0e-9 ) + 1;
+   nlon = (int) ceil( (lon1 - lon0)/dlon - 1.0e-9 ) + 1;
+   if( nlat < 2 ) nlat = 2;
+   if( nlon < 2 ) nlon = 2;
+
+   flat = lnzGridCreate( lat0, dlat, nlat, lon0, dlon, nlon );
+   if( ! flat || ! lnzGridIsOk( flat ) ) return flat;
+
+   strcpy( flat->datum0, grids[0]->datum0 );
+   strcpy( flat->datum1, grids[0]->datum1 );
+   flat->usefallback = grids[0]->usefallback;
+   flat->fbmargin = grids[0]->fbmargin;
+   flat->fallback = grids[0]->fallback;
+
+   /* Resample the hierarchy at the flattened grid nodes */
+
+   nmissing = 0;
+   for( nlt = 0; nlt < nlat; nlt++ ) {
+      lt = lat0 + nlt*dlat;
+      f = flat->grid[nlt];
+      for( nln = 0; nln < nlon; nln++, f += 2 ) {
+         ln = lon0 + nln*dlon;
+         if( flatLookup( grids, ngrid, lt, ln, &shlt, &shln ) ) {
+            f[0] = (float) shlt;
+            f[1] = (float) shln;
+            }
+         else {
+            f[0] = f[1] = NAN;
+            nmissing++;
+            }
+         }
+      }
+
+   if( nmissing && lnzGridSetNoData( flat, HUGE_VAL ) < 0 ) {
+      lnzGridDestroy( flat );
+      free( flat );
+      return NULL;
+      }
+
+   /* Estimate the resampling error within each cell */
+
+   flterr = 0.0;
+   for( nlt = 0; nlt < nlat-1; nlt++ ) {
+      for( nln = 0; nln < nlon-1; nln++ ) {
+         for( i = 0; i < 5; i++ ) {
+            static double offset[5][2] =
+               { {0.5,0.5}, {0.0,0.5}, {0.5,0.0}, {1.0,0.5}, {0.5,1.0} };
+            double fshlt, fshln;
+            lt = lat0 + (nlt + offset[i][0])*dlat;
+            ln = lon0 + (nln + offset[i][1])*dlon;
+            if( ! flatLookup( grids, ngrid, lt, ln, &shlt, &shln ) ) continue;
+            lnzGridShift( flat, lt, ln, &fshlt, &fshln );
+            if( fshlt != fshlt || fshln != fshln ) continue;
+            err = lnzGridShiftDistance( lt, fshlt - shlt, fshln - shln );
+            if( err > flterr ) flterr = err;
+            }
+         }
+      }
+
+   if( size ) *size = (long) nlat * nlon * 2 * sizeof(float);
+   if( maxerr ) *maxerr = flterr;
+
+   return flat;
+   }
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,30 @@
+#ifndef LINZGRIDFLAT_H
+#define LINZGRIDFLAT_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Flattening of a hierarchy of grids (a parent grid with denser child
+*  grids, as in NTv2 subgrids) into a single uniform lnzGrid, so that a
+*  lookup is a single index calculation.
+*
+*  See the comments in linzgridflat.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+lnzGrid *lnzGridFlatten( lnzGrid **grids, int ngrid,
+                         double lat0, double lat1, double lon0, double lon1,
+                         long *size, double *maxerr );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
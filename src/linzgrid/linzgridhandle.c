@@ -0,0 +1,247 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module provides a handle to a grid that can be replaced while
+*  it is in use, so that a long running service can pick up a revised
+*  grid file without stopping.  A new version is loaded with the usual
+*  functions (such as lnzGridCreateFromNTv2Asc) and swapped into the
+*  handle atomically.  Transformations already in progress continue to
+*  use the version they started with, and subsequent transformations
+*  use the new version.
+*
+*  Readers are protected with hazard pointers.  Each reader thread 
+*  attaches to the handle once to obtain a reader slot.  To use the grid
+*  it publishes the grid pointer in its slot, and checks that the grid
+*  is still current.  A replaced grid is only released when it is not
+*  published in any slot.  Readers take no locks and never wait for the
+*  thread updating the grid.
+*
+*  The handle holds a reference to each of its grids (see lnzGridAddRef), 
+*  so the grids may also be shared with a registry (linzgridregistry.c).
+*
+*  A typical reader is
+*
+*     reader = lnzGridHandleAttach( handle );
+*     ...
+*     grid = lnzGridHandleAcquire( handle, reader );
+*     lnzGridTransformBatch( grid, npt, lts, lns, ltd, lnd, 0, status );
+*     lnzGridHandleRelease( handle, reader );
+*     ...
+*     lnzGridHandleDetach( handle, reader );
+*
+*  The grid must not be used after it is released, and must be treated
+*  as read only (see linzgridregistry.c).  lnzGridHandleUpdate and 
+*  lnzGridHandleReclaim must only be called by one thread at a time.
+*
+***********************************************************************
+*  This module provides the following functions.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGridHandle *lnzGridHandleCreate( lnzGrid *grid );
+*
+*     Creates a handle with an initial grid.
+*
+*     Parameters
+*        grid      The initial grid.  The handle takes ownership of the
+*                  grid, which must have been allocated with malloc, as
+*                  for lnzGridRegistryAdd.
+*
+*     Returns
+*        lnzGridHandle *  The handle, or NULL if the grid is not valid 
+*                  or memory cannot be allocated.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridHandleDestroy( lnzGridHandle *handle );
+*
+*     Destroys the handle and releases the current and any retired 
+*     grids.  No reader may be using the handle.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridHandleAttach( lnzGridHandle *handle );
+*  void lnzGridHandleDetach( lnzGridHandle *handle, int reader );
+*
+*     Allocates and frees a reader slot.  Each thread using the handle 
+*     concurrently requires its own slot.  lnzGridHandleAttach returns 
+*     the slot number, or -1 if all LNZGRID_MAX_READERS slots are in use.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGrid *lnzGridHandleAcquire( lnzGridHandle *handle, int reader );
+*  void lnzGridHandleRelease( lnzGridHandle *handle, int reader );
+*
+*     Obtains the current grid for a reader, and releases it again.  The
+*     grid is guaranteed to remain valid until it is released, even if 
+*     the handle is updated in the meantime.  A reader can hold only one
+*     grid from each handle at a time.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridHandleUpdate( lnzGridHandle *handle, lnzGrid *grid );
+*
+*     Replaces the current grid.  The handle takes ownership of the new
+*     grid.  The old grid is retired and released once no reader is
+*     using it.
+*
+*     Returns
+*        int       1 (true) if the grid is replaced, or 0 (false) if the
+*                  new grid is not valid or memory cannot be allocated.
+*                  In that case the current grid is unchanged and the new
+*                  grid remains owned by the caller.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridHandleReclaim( lnzGridHandle *handle );
+*
+*     Releases any retired grids that are no longer in use.  This is 
+*     called by lnzGridHandleUpdate, and may be called periodically to 
+*     release grids that were still in use at the time of the update.
+*
+*     Returns
+*        int       The number of retired grids still in use.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "linzgridhandle.h"
+#include "linzgridatomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+*  lnzGridHandleCreate, lnzGridHandleDestroy
+***********************************************************************
+*/
+
+lnzGridHandle *lnzGridHandleCreate( lnzGrid *grid ) {
+   lnzGridHandle *handle;
+
+   if( ! lnzGridIsOk( grid ) ) return NULL;
+   handle = (lnzGridHandle *) calloc( 1, sizeof(lnzGridHandle) );
+   if( ! handle ) return handle;
+   handle->current = lnzGridAddRef( grid );
+   return handle;
+   }
+
+void lnzGridHandleDestroy( lnzGridHandle *handle ) {
+   int nr;
+   if( ! handle ) return;
+   lnzGridRelease( handle->current );
+   for( nr = 0; nr < handle->nretired; nr++ ) {
+      lnzGridRelease( handle->retired[nr] );
+      }
+   if( handle->retired ) free( handle->retired );
+   free( handle );
+   }
+
+/***********************************************************************
+*  lnzGridHandleAttach, lnzGridHandleDetach
+***********************************************************************
+*/
+
+int lnzGridHandleAttach( lnzGridHandle *handle ) {
+   int reader;
+   for( reader = 0; reader < LNZGRID_MAX_READERS; reader++ ) {
+      if( LNZ_ATOMIC_CAS( &(handle->inuse[reader]), 0, 1 ) ) return reader;
+      }
+   return -1;
+   }
+
+void lnzGridHandleDetach( lnzGridHandle *handle, int reader ) {
+   LNZ_ATOMIC_STORE_PTR( &(handle->hazard[reader]), (lnzGrid *) NULL );
+   LNZ_ATOMIC_CAS( &(handle->inuse[reader]), 1, 0 );
+   }
+
+/***********************************************************************
+*  lnzGridHandleAcquire, lnzGridHandleRelease
+*
+*  The reader publishes the grid it has read, then checks that it is 
+*  still current.  If it is, an updating thread that replaces it after
+*  this point will see the published pointer when it scans the slots.
+***********************************************************************
+*/
+
+lnzGrid *lnzGridHandleAcquire( lnzGridHandle *handle, int reader ) {
+   lnzGrid *grid, *check;
+   grid = (lnzGrid *) LNZ_ATOMIC_LOAD_PTR( &(handle->current) );
+   for( ;; ) {
+      LNZ_ATOMIC_STORE_PTR( &(handle->hazard[reader]), grid );
+      check = (lnzGrid *) LNZ_ATOMIC_LOAD_PTR( &(handle->current) );
+      if( check == grid ) return grid;
+      grid = check;
+      }
+   }
+
+void lnzGridHandleRelease( lnzGridHandle *handle, int reader ) {
+   LNZ_ATOMIC_STORE_PTR( &(handle->hazard[reader]), (lnzGrid *) NULL );
+   }
+
+/***********************************************************************
+*  lnzGridHandleUpdate
+***********************************************************************
+*/
+
+int lnzGridHandleUpdate( lnzGridHandle *handle, lnzGrid *grid ) {
+   lnzGrid *old;
+
+   if( ! lnzGridIsOk( grid ) ) return 0;
+
+   /* Make space to retire the old grid before swapping */
+
+   if( handle->nretired >= handle->maxretired ) {
+      lnzGrid **retired;
+      int maxretired = handle->maxretired ? handle->maxretired*2 : 4;
+      retired = (lnzGrid **) realloc( handle->retired, 
+                                       maxretired*sizeof(lnzGrid *) );
+      if( ! retired ) return 0;
+      handle->retired = retired;
+      handle->maxretired = maxretired;
+      }
+
+   lnzGridAddRef( grid );
+   old = (lnzGrid *) LNZ_ATOMIC_XCHG_PTR( &(handle->current), grid );
+   handle->retired[handle->nretired++] = old;
+
+   lnzGridHandleReclaim( handle );
+   return 1;
+   }
+
+/***********************************************************************
+*  lnzGridHandleReclaim
+*
+*  Releases each retired grid that is not published in a reader slot.
+***********************************************************************
+*/
+
+int lnzGridHandleReclaim( lnzGridHandle *handle ) {
+   int nr, nkeep, reader, inuse;
+
+   nkeep = 0;
+   for( nr = 0; nr < handle->nretired; nr++ ) {
+      lnzGrid *grid = handle->retired[nr];
+      inuse = 0;
+      for( reader = 0; reader < LNZGRID_MAX_READERS; reader++ ) {
+         if( LNZ_ATOMIC_LOAD_PTR( &(handle->hazard[reader]) ) == grid ) {
+            inuse = 1;
+            break;
+            }
+         }
+      if( inuse ) handle->retired[nkeep++] = grid;
+      else lnzGridRelease( grid );
+      }
+   handle->nretired = nkeep;
+   return nkeep;
+   }
+
+#ifdef __cplusplus
+};
+#endif
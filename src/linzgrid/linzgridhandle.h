@@ -0,0 +1,56 @@
+#ifndef LINZGRIDHANDLE_H
+#define LINZGRIDHANDLE_H
+/***********************************************************************
+*
+*  Description:
+*
+*  A handle to the current version of a grid, which can be replaced 
+*  with a newly loaded grid while other threads are transforming points
+*  with it.  Readers take no locks, and old versions are reclaimed once
+*  no reader is using them.
+*
+*  See the comments in linzgridhandle.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+#define LNZGRID_MAX_READERS 64
+
+typedef struct {
+   lnzGrid *current;                    /* The current version of the grid */
+   lnzGrid *hazard[LNZGRID_MAX_READERS]; /* The grid in use by each reader */
+   long inuse[LNZGRID_MAX_READERS];     /* Flags whether each reader slot 
+                                           is allocated */
+   int nretired;                        /* The number of replaced grids
+                                           not yet reclaimed */
+   int maxretired;                      /* The size of the retired array */
+   lnzGrid **retired;                   /* The replaced grids */
+} lnzGridHandle;
+
+lnzGridHandle *lnzGridHandleCreate( lnzGrid *grid );
+
+void     lnzGridHandleDestroy( lnzGridHandle *handle );
+
+int      lnzGridHandleAttach( lnzGridHandle *handle );
+
+void     lnzGridHandleDetach( lnzGridHandle *handle, int reader );
+
+lnzGrid *lnzGridHandleAcquire( lnzGridHandle *handle, int reader );
+
+void     lnzGridHandleRelease( lnzGridHandle *handle, int reader );
+
+int      lnzGridHandleUpdate( lnzGridHandle *handle, lnzGrid *grid );
+
+int      lnzGridHandleReclaim( lnzGridHandle *handle );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,213 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module backs grid data with 2 MB huge pages.  Transformations 
+*  of scattered points touch grid rows all over the grid, and with 
+*  normal 4 kB pages a large grid needs many more TLB entries than the
+*  processor has.
+*
+*  For grids loaded onto the heap the data is moved into a new anonymous
+*  mapping.  Reserved huge pages (MAP_HUGETLB) are used if the system 
+*  has any available.  Otherwise the mapping is aligned to a huge page
+*  boundary and the kernel is asked to use transparent huge pages for
+*  it (madvise MADV_HUGEPAGE).  For grids that are already mapped, such
+*  as grids attached from shared memory (linzgridshm.c), only the 
+*  transparent huge page request is made.  Whether this succeeds for 
+*  shared memory depends on the system shmem_enabled setting.
+*
+*  The hugepages member of the grid records the result.  For
+*  LNZGRID_HUGE_THP the kernel has accepted the request, but may not
+*  have been able to provide huge pages for all of the data.  If 
+*  neither method is available the grid is left unchanged.
+*
+***********************************************************************
+*  This module provides the following function.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridUseHugePages( lnzGrid *grid );
+*
+*     Backs the grid data with huge pages if possible.  This should be
+*     called after the grid is loaded and before it is shared with other
+*     threads.
+*
+*     Parameters
+*        grid      The grid
+*
+*     Returns
+*        int       The hugepages status of the grid, one of 
+*                  LNZGRID_HUGE_NONE, LNZGRID_HUGE_TLB, or 
+*                  LNZGRID_HUGE_THP.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "linzgridhuge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+*  hugeAdvise
+*
+*  Requests transparent huge pages for the huge page aligned part of a
+*  block of memory.  Returns 1 (true) if the request is accepted.
+***********************************************************************
+*/
+
+static int hugeAdvise( void *addr, size_t len ) {
+#ifdef MADV_HUGEPAGE
+   char *start = (char *) addr;
+   char *end = start + len;
+   start = (char *) ((((size_t) start) + LNZGRID_HUGE_PAGE_SIZE - 1) & 
+                     ~((size_t) LNZGRID_HUGE_PAGE_SIZE - 1));
+   end = (char *) (((size_t) end) & ~((size_t) LNZGRID_HUGE_PAGE_SIZE - 1));
+   if( end <= start ) return 0;
+   return madvise( start, end - start, MADV_HUGEPAGE ) == 0;
+#else
+   return 0;
+#endif
+   }
+
+/***********************************************************************
+*  hugeMap
+*
+*  Allocates an anonymous mapping of at least len bytes, using reserved
+*  huge pages if possible and otherwise aligned to a huge page boundary
+*  with transparent huge pages requested.  Returns the mapping and its
+*  length, and the huge page status, or NULL if no memory is available
+*  or neither kind of huge page can be used.
+***********************************************************************
+*/
+
+static void *hugeMap( size_t len, size_t *maplen, int *hugepages ) {
+   char *map, *start;
+   size_t extra;
+
+   len = (len + LNZGRID_HUGE_PAGE_SIZE - 1) & 
+         ~((size_t) LNZGRID_HUGE_PAGE_SIZE - 1);
+
+#ifdef MAP_HUGETLB
+   map = (char *) mmap( NULL, len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+   if( map != (char *) MAP_FAILED ) {
+      *maplen = len;
+      *hugepages = LNZGRID_HUGE_TLB;
+      return map;
+      }
+#endif
+
+   /* Map an extra huge page, and trim the ends so that the mapping is
+      aligned */
+
+   map = (char *) mmap( NULL, len + LNZGRID_HUGE_PAGE_SIZE, 
+                        PROT_READ | PROT_WRITE, 
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+   if( map == (char *) MAP_FAILED ) return NULL;
+
+   start = (char *) ((((size_t) map) + LNZGRID_HUGE_PAGE_SIZE - 1) & 
+                     ~((size_t) LNZGRID_HUGE_PAGE_SIZE - 1));
+   if( start > map ) munmap( map, start - map );
+   extra = (map + len + LNZGRID_HUGE_PAGE_SIZE) - (start + len);
+   if( extra ) munmap( start + len, extra );
+
+   if( ! hugeAdvise( start, len ) ) {
+      munmap( start, len );
+      return NULL;
+      }
+
+   *maplen = len;
+   *hugepages = LNZGRID_HUGE_THP;
+   return start;
+   }
+
+/***********************************************************************
+*  hugeRelease
+*
+*  Release function for grids moved into a huge page mapping, called by
+*  lnzGridDestroy.
+***********************************************************************
+*/
+
+static void hugeRelease( lnzGrid *grid ) {
+   if( grid->mapping ) munmap( grid->mapping, grid->maplen );
+   if( grid->grid ) free( grid->grid );
+   grid->mapping = NULL;
+   grid->maplen = 0;
+   grid->grid = NULL;
+   grid->hugepages = LNZGRID_HUGE_NONE;
+   }
+
+/***********************************************************************
+*  lnzGridUseHugePages
+*
+*  Grids with a release function already use mapped storage, and are 
+*  only advised.  Otherwise the data is copied to a new mapping, and the
+*  original storage released if the grid owns it.
+***********************************************************************
+*/
+
+int lnzGridUseHugePages( lnzGrid *grid ) {
+   float *data, **rows, **f;
+   size_t len, maplen, rowlen;
+   int hugepages, nlt, nf;
+
+   if( ! lnzGridIsOk( grid ) ) return LNZGRID_HUGE_NONE;
+   if( grid->hugepages != LNZGRID_HUGE_NONE ) return grid->hugepages;
+
+   if( grid->release ) {
+      if( grid->mapping && hugeAdvise( grid->mapping, grid->maplen ) ) {
+         grid->hugepages = LNZGRID_HUGE_THP;
+         }
+      return grid->hugepages;
+      }
+
+   rowlen = (size_t) grid->nlon * 2;
+   len = (size_t) grid->nlat * rowlen * sizeof(float);
+   rows = (float **) malloc( grid->nlat * sizeof(float *) );
+   if( ! rows ) return LNZGRID_HUGE_NONE;
+   data = (float *) hugeMap( len, &maplen, &hugepages );
+   if( ! data ) {
+      free( rows );
+      return LNZGRID_HUGE_NONE;
+      }
+
+   for( nlt = 0; nlt < grid->nlat; nlt++ ) {
+      rows[nlt] = data + nlt*rowlen;
+      memcpy( rows[nlt], grid->grid[nlt], rowlen*sizeof(float) );
+      }
+
+   /* Release the original storage */
+
+   if( grid->owngrid ) {
+      if( grid->data ) {
+         free( grid->data );
+         }
+      else {
+         for( f = grid->grid, nf = grid->nlat; nf; nf--, f++ ) {
+            if( *f ) free( *f );
+            }
+         }
+      free( grid->grid );
+      }
+
+   grid->grid = rows;
+   grid->data = NULL;
+   grid->owngrid = 0;
+   grid->mapping = data;
+   grid->maplen = maplen;
+   grid->release = hugeRelease;
+   grid->hugepages = hugepages;
+   return hugepages;
+   }
+
+#ifdef __cplusplus
+};
+#endif
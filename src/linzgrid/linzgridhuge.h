@@ -0,0 +1,29 @@
+#ifndef LINZGRIDHUGE_H
+#define LINZGRIDHUGE_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Backing of grid data with huge pages, to reduce TLB misses when 
+*  large grids are accessed at random.
+*
+*  See the comments in linzgridhuge.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+#define LNZGRID_HUGE_PAGE_SIZE (2L*1024L*1024L)
+
+int lnzGridUseHugePages( lnzGrid *grid );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -89,6 +89,15 @@ lnzGrid *lnzGridCreateFromNTv2Asc( char *ascfile ){
    grid->datum1[0] = 0;
    grid->errmsg[0] = 0;
    grid->grid = NULL;
+   grid->coverage = NULL;
+   grid->usefallback = 0;
+   grid->data = NULL;
+   grid->refcount = 0;
+   grid->mapping = NULL;
+   grid->maplen = 0;
+   grid->release = NULL;
+   grid->hugepages = LNZGRID_HUGE_NONE;
+   grid->prefetch = 0;
 
    /* Now try to open the file */
 
@@ -321,19 +330,24 @@ lnzGrid *lnzGridCreateFromNTv2Asc( char *ascfile ){
           }
        }
 
-   /* Allocate the grid array */
+   /* Allocate the grid array.  The data is held in a single block, with
+      the rows stored consecutively, so that neighbouring rows are close
+      in memory and the grid can be copied in one operation */
 
    if( ok ) {
        grid->grid = (float **) malloc( grid->nlat * sizeof(float *) );
-       if( ! grid->grid ) {
+       grid->data = (float *) malloc( (size_t) grid->nlat * grid->nlon * 2 * sizeof(float) );
+       if( ! grid->grid || ! grid->data ) {
           ok = 0;
+          if( grid->grid ) free( grid->grid );
+          if( grid->data ) free( grid->data );
+          grid->grid = NULL;
+          grid->data = NULL;
           }
        else {
           int nlt;
-          for( nlt = 0; nlt < grid->nlat; nlt++ ) { grid->grid[nlt] = NULL; }
-          for( nlt = 0; ok && nlt < grid->nlat; nlt++ ) {
-              grid->grid[nlt] = (float *) malloc( 2 * grid->nlon * sizeof(float) );
-              if( ! grid->grid[nlt] ) ok = 0;
+          for( nlt = 0; nlt < grid->nlat; nlt++ ) {
+              grid->grid[nlt] = grid->data + (size_t) nlt * grid->nlon * 2;
               }
           }
        if( ! ok ) strcpy( grid->errmsg,"Cannot allocate sufficient memory for grid");
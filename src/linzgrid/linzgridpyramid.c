@@ -0,0 +1,218 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module builds multi-resolution pyramids from a lnzGrid.  Each
+*  level of the pyramid is a grid with twice the node spacing of the
+*  previous level, with the nodes sampled from the source grid.  The
+*  maximum interpolation error of each level against the source grid
+*  is recorded, so that a caller can use the smallest grid that meets
+*  a required accuracy.  This is intended for applications such as map
+*  display, where sub-metre accuracy is sufficient and a grid that fits
+*  in the processor cache is more valuable than survey accuracy.
+*
+***********************************************************************
+*  This module provides the following functions.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGridPyramid *lnzGridPyramidCreate( lnzGrid *grid, int nlevel );
+*
+*     Creates a pyramid from a grid.
+*
+*     Parameters
+*        grid      The source grid.  This becomes level 0 of the pyramid,
+*                  and must not be destroyed before the pyramid.  Grids
+*                  with missing data (see lnzGridSetNoData) are not
+*                  supported.
+*        nlevel    The number of levels required, including the source.
+*                  Fewer levels are created if the grid becomes a single
+*                  cell, or if nlevel exceeds LNZGRID_MAX_LEVELS.
+*
+*     Returns
+*        lnzGridPyramid *  The pyramid, or NULL if the grid is not valid
+*                  or the pyramid could not be allocated.  The nlevel,
+*                  maxerr (metres) and size (bytes) members describe the
+*                  levels.  Each level has the same extents and fallback
+*                  transformation as the source grid.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridPyramidDestroy( lnzGridPyramid *pyramid );
+*
+*     Destroys the pyramid and all levels other than the source grid.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGrid *lnzGridPyramidSelect( lnzGridPyramid *pyramid,
+*                                 double tolerance );
+*
+*     Returns the smallest level of the pyramid for which the maximum
+*     interpolation error is within the tolerance.
+*
+*     Parameters
+*        pyramid   The pyramid
+*        tolerance The required accuracy in metres
+*
+*     Returns
+*        lnzGrid * The grid to use.  This is the source grid if no other
+*                  level is accurate enough.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "linzgridpyramid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+*  lnzGridPyramidLevel
+*
+*  Creates a level of the pyramid by sampling every step'th node of the
+*  source grid.  The level extends at least as far as the source grid,
+*  nodes beyond the source being extrapolated from its edge cells.  The
+*  nodes of each level coincide with source nodes, so the difference
+*  between the level and the source is bilinear within each source cell,
+*  and its maximum is found by testing the source nodes.
+***********************************************************************
+*/
+
+static lnzGrid *lnzGridPyramidLevel( lnzGrid *src, int step, double *maxerr ) {
+   lnzGrid *grid;
+   int nlat, nlon, nlt, nln;
+   double lt, ln, shlt, shln, err;
+   float *f;
+
+   nlat = (src->nlat-2)/step + 2;
+   nlon = (src->nlon-2)/step + 2;
+
+   grid = lnzGridCreate( src->lat0, src->dlat*step, nlat,
+                         src->lon0, src->dlon*step, nlon );
+   if( ! grid ) return grid;
+   if( ! lnzGridIsOk( grid ) ) {
+      lnzGridDestroy( grid );
+      free( grid );
+      return NULL;
+      }
+
+   /* Use the source extents so that range checking is unchanged */
+
+   grid->lat1 = src->lat1;
+   grid->lon1 = src->lon1;
+   strcpy( grid->datum0, src->datum0 );
+   strcpy( grid->datum1, src->datum1 );
+   grid->usefallback = src->usefallback;
+   grid->fbmargin = src->fbmargin;
+   grid->fallback = src->fallback;
+
+   for( nlt = 0; nlt < nlat; nlt++ ) {
+      lt = src->lat0 + nlt*grid->dlat;
+      f = grid->grid[nlt];
+      for( nln = 0; nln < nlon; nln++, f += 2 ) {
+         ln = src->lon0 + nln*grid->dlon;
+         lnzGridShift( src, lt, ln, &shlt, &shln );
+         f[0] = (float) shlt;
+         f[1] = (float) shln;
+         }
+      }
+
+   *maxerr = 0.0;
+   for( nlt = 0; nlt < src->nlat; nlt++ ) {
+      lt = src->lat0 + nlt*src->dlat;
+      f = src->grid[nlt];
+      for( nln = 0; nln < src->nlon; nln++, f += 2 ) {
+         ln = src->lon0 + nln*src->dlon;
+         lnzGridShift( grid, lt, ln, &shlt, &shln );
+         err = lnzGridShiftDistance( lt, shlt - f[0], shln - f[1] );
+         if( err > *maxerr ) *maxerr = err;
+         }
+      }
+
+   return grid;
+   }
+
+/***********************************************************************
+*  lnzGridPyramidCreate
+*
+*  Creates the pyramid, stopping when the grid is reduced to a single
+*  cell.
+***********************************************************************
+*/
+
+lnzGridPyramid *lnzGridPyramidCreate( lnzGrid *grid, int nlevel ) {
+   lnzGridPyramid *pyramid;
+   lnzGrid *level;
+   int lv;
+
+   if( ! lnzGridIsOk( grid ) || grid->coverage ) return NULL;
+
+   pyramid = (lnzGridPyramid *) calloc( 1, sizeof(lnzGridPyramid) );
+   if( ! pyramid ) return pyramid;
+
+   if( nlevel > LNZGRID_MAX_LEVELS ) nlevel = LNZGRID_MAX_LEVELS;
+
+   pyramid->level[0] = grid;
+   pyramid->maxerr[0] = 0.0;
+   pyramid->size[0] = (long) grid->nlat * grid->nlon * 2 * sizeof(float);
+   pyramid->nlevel = 1;
+
+   for( lv = 1; lv < nlevel; lv++ ) {
+      level = pyramid->level[lv-1];
+      if( level->nlat == 2 && level->nlon == 2 ) break;
+
+      level = lnzGridPyramidLevel( grid, 1 << lv, &(pyramid->maxerr[lv]) );
+      if( ! level ) break;
+
+      pyramid->level[lv] = level;
+      pyramid->size[lv] = (long) level->nlat * level->nlon * 2 * sizeof(float);
+      pyramid->nlevel++;
+      }
+
+   return pyramid;
+   }
+
+/***********************************************************************
+*  lnzGridPyramidDestroy
+*
+*  Releases the levels created for the pyramid, and the pyramid itself.
+***********************************************************************
+*/
+
+void lnzGridPyramidDestroy( lnzGridPyramid *pyramid ) {
+   int lv;
+   if( ! pyramid ) return;
+   for( lv = 1; lv < pyramid->nlevel; lv++ ) {
+      lnzGridDestroy( pyramid->level[lv] );
+      free( pyramid->level[lv] );
+      }
+   free( pyramid );
+   }
+
+/***********************************************************************
+*  lnzGridPyramidSelect
+*
+*  Returns the coarsest level that meets the tolerance.  The error does
+*  not always increase with level, so the levels are searched from the
+*  coarsest down.
+***********************************************************************
+*/
+
+lnzGrid *lnzGridPyramidSelect( lnzGridPyramid *pyramid, double tolerance ) {
+   int lv;
+   if( ! pyramid ) return NULL;
+   for( lv = pyramid->nlevel; --lv > 0; ) {
+      if( pyramid->maxerr[lv] <= tolerance ) return pyramid->level[lv];
+      }
+   return pyramid->level[0];
+   }
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,43 @@
+#ifndef LINZGRIDPYRAMID_H
+#define LINZGRIDPYRAMID_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Multi-resolution pyramids of lnzGrid grids.  Each level of the 
+*  pyramid is the grid subsampled at twice the spacing of the previous
+*  level, and records the maximum interpolation error of the level 
+*  relative to the source grid.  A caller can then request the smallest
+*  level that meets a required accuracy.
+*
+*  See the comments in linzgridpyramid.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+#define LNZGRID_MAX_LEVELS 16
+
+typedef struct {
+   int nlevel;                          /* The number of levels */
+   lnzGrid *level[LNZGRID_MAX_LEVELS];  /* The grids, level 0 is the source */
+   double maxerr[LNZGRID_MAX_LEVELS];   /* Maximum error of each level (m) */
+   long size[LNZGRID_MAX_LEVELS];       /* Size of the grid data (bytes) */
+} lnzGridPyramid;
+
+lnzGridPyramid *lnzGridPyramidCreate( lnzGrid *grid, int nlevel );
+
+void     lnzGridPyramidDestroy( lnzGridPyramid *pyramid );
+
+lnzGrid *lnzGridPyramidSelect( lnzGridPyramid *pyramid, double tolerance );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
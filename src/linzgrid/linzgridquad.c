@@ -0,0 +1,450 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module builds an adaptive quadtree representation of a lnzGrid.
+*  Large parts of a shift grid are often close to planar, and can be
+*  represented by a few bilinear patches rather than by every grid node.
+*  The tree covers a square of 2^depth grid cells from the grid origin.
+*  Each leaf is a bilinear patch between the shifts at its four corners,
+*  and a node is only subdivided if its patch differs from the source 
+*  grid by more than the tolerance.
+*
+*  The leaf boundaries always fall on source grid nodes, so within each
+*  source cell the difference between the leaf patch and the source grid
+*  is itself bilinear.  The error of a leaf is therefore found exactly
+*  by testing the source nodes that it covers, and the maximum error
+*  recorded for the tree is a strict bound on the error at any point in
+*  the grid.
+*
+*  The corners of the patches are shared rather than stored for each
+*  leaf.  Subdividing a node adds only the shifts at the midpoints of its
+*  edges and its centre, so the tree stores the four corners of the root
+*  and five points for each subdivided node.  The four children of a
+*  subdivided node form a block, stored as a single integer holding a
+*  mask of the subdivided children and the index of the first of their
+*  blocks, which are stored consecutively.  Leaves take no storage.  A
+*  lookup descends through the blocks keeping track of the corners of
+*  the current node.
+*
+***********************************************************************
+*  This module provides the following functions.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGridQuad *lnzGridQuadCreate( lnzGrid *grid, double tolerance );
+*
+*     Creates a quadtree from a grid.  The tree does not refer to the grid
+*     after it has been created.
+*
+*     Parameters
+*        grid      The source grid.  Grids with missing data (see
+*                  lnzGridSetNoData) are not supported.
+*        tolerance The maximum allowable error in metres
+*
+*     Returns
+*        lnzGridQuad * The quadtree, or NULL if the grid is not valid or
+*                  the tree could not be allocated.  The maxerr member
+*                  gives the actual maximum error, the size member
+*                  the memory used, and the gridsize member the memory
+*                  used by the source grid data.  The tree is only 
+*                  smaller than the grid where the tolerance allows most
+*                  cells to be merged - for the NZGD2000 grid it is 
+*                  about a quarter of the size at 1 metre, slightly 
+*                  smaller at 0.1 metres, and larger at 0.01 metres.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridQuadDestroy( lnzGridQuad *quad );
+*
+*     Releases the memory used by the quadtree.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridQuadShift( lnzGridQuad *quad, double lts, double lns,
+*                         double *ltshift, double *lnshift );
+*
+*     Returns the latitude and longitude shift at a point, without any
+*     range checking.  Points outside the grid are clamped to the
+*     extents of the tree.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridQuadTransform( lnzGridQuad *quad, double lts, double lns,
+*                            double *ltd, double *lnd, int reverse );
+*
+*     Applies a forward or reverse transformation to a point, as for
+*     lnzGridTransform.  Returns 0 (false) if the point is outside the
+*     range of the grid, and non-zero (true) otherwise.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "linzgridquad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Structure used while building the tree */
+
+typedef struct {
+   lnzGrid *grid;
+   lnzGridQuad *quad;
+   int maxblock;
+   int ok;
+   } quadBuild;
+
+/* Offsets of the corners (SW, SE, NW, NE) of each child of a node in 
+   the list of the node's corners followed by its S, W, centre, E, and N
+   points */
+
+static int quadChildCorner[4][4] = {
+   { 0, 4, 5, 6 }, { 4, 1, 6, 7 }, { 5, 6, 2, 8 }, { 6, 7, 8, 3 } };
+
+/* The number of bits set in each mask of subdivided children */
+
+static int quadMaskCount[16] = 
+   { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+/***********************************************************************
+*  quadAddBlocks
+*
+*  Allocates space for consecutive new blocks, growing the arrays as
+*  required.  Returns the index of the first new block, or -1 if memory
+*  cannot be allocated.
+***********************************************************************
+*/
+
+static int quadAddBlocks( quadBuild *b, int nblock ) {
+   lnzGridQuad *quad = b->quad;
+   int n;
+   if( quad->nblock + nblock > b->maxblock ) {
+      unsigned int *block;
+      float *value;
+      int maxblock = b->maxblock ? b->maxblock*2 : 256;
+      while( maxblock < quad->nblock + nblock ) maxblock *= 2;
+      block = (unsigned int *) realloc( quad->block, 
+                                        maxblock*sizeof(unsigned int) );
+      if( ! block ) { b->ok = 0; return -1; }
+      quad->block = block;
+      value = (float *) realloc( quad->value, 
+                                 (4 + 5*maxblock)*2*sizeof(float) );
+      if( ! value ) { b->ok = 0; return -1; }
+      quad->value = value;
+      b->maxblock = maxblock;
+      }
+   n = quad->nblock;
+   quad->nblock += nblock;
+   return n;
+   }
+
+/***********************************************************************
+*  quadSample
+*
+*  Sets the shift at the node at row r, column c of the grid into v.
+*  Nodes beyond the grid are extrapolated from its edge cells.
+***********************************************************************
+*/
+
+static void quadSample( lnzGrid *grid, int r, int c, float *v ) {
+   double shlt, shln;
+   lnzGridShift( grid, grid->lat0 + r*grid->dlat, grid->lon0 + c*grid->dlon,
+                 &shlt, &shln );
+   v[0] = (float) shlt;
+   v[1] = (float) shln;
+   }
+
+/***********************************************************************
+*  quadPatchError
+*
+*  Calculates the maximum difference between the bilinear patch defined
+*  by corner shifts c over the block of cells starting at row r0,
+*  column c0 with the given size, and the source grid nodes in the
+*  block.  Blocks wholly outside the grid have no nodes to test.
+***********************************************************************
+*/
+
+static double quadPatchError( lnzGrid *grid, int r0, int c0, int size,
+                              float *c[4] ) {
+   int r, col, r1, c1;
+   double fy, fx, shlt, shln, err, maxerr;
+   float *f;
+
+   maxerr = 0.0;
+   r1 = r0 + size;
+   c1 = c0 + size;
+   if( r1 > grid->nlat-1 ) r1 = grid->nlat-1;
+   if( c1 > grid->nlon-1 ) c1 = grid->nlon-1;
+
+   for( r = r0; r <= r1; r++ ) {
+      fy = ((double)(r - r0))/size;
+      f = grid->grid[r] + 2*c0;
+      for( col = c0; col <= c1; col++, f += 2 ) {
+         fx = ((double)(col - c0))/size;
+         shlt = (c[0][0]*(1-fx) + c[1][0]*fx)*(1-fy) + 
+                (c[2][0]*(1-fx) + c[3][0]*fx)*fy;
+         shln = (c[0][1]*(1-fx) + c[1][1]*fx)*(1-fy) + 
+                (c[2][1]*(1-fx) + c[3][1]*fx)*fy;
+         err = lnzGridShiftDistance( grid->lat0 + r*grid->dlat,
+                                     shlt - f[0], shln - f[1] );
+         if( err > maxerr ) maxerr = err;
+         }
+      }
+   return maxerr;
+   }
+
+/***********************************************************************
+*  quadBuildBlock
+*
+*  Builds block k, holding the children of the node covering the cells
+*  starting at row r0, column c0, with the given size.  corner gives 
+*  the indices in the value array of the node's SW, SE, NW, and NE 
+*  corners.  A child becomes a leaf if its patch meets the tolerance or
+*  it is a single cell, otherwise it is subdivided.  The blocks of the
+*  subdivided children are allocated together before any of them are 
+*  built, so that they are consecutive.
+***********************************************************************
+*/
+
+static void quadBuildBlock( quadBuild *b, int k, int r0, int c0, int size,
+                            int *corner ) {
+   lnzGrid *grid = b->grid;
+   lnzGridQuad *quad = b->quad;
+   int point[9], child[4][4];
+   float *c[4];
+   double err;
+   int half, mask, first, i, q;
+
+   half = size/2;
+
+   /* Sample the S, W, centre, E, and N points of the node */
+
+   for( i = 0; i < 4; i++ ) point[i] = corner[i];
+   for( i = 0; i < 5; i++ ) point[4+i] = 4 + 5*k + i;
+   quadSample( grid, r0,        c0+half,   quad->value + 2*point[4] );
+   quadSample( grid, r0+half,   c0,        quad->value + 2*point[5] );
+   quadSample( grid, r0+half,   c0+half,   quad->value + 2*point[6] );
+   quadSample( grid, r0+half,   c0+size,   quad->value + 2*point[7] );
+   quadSample( grid, r0+size,   c0+half,   quad->value + 2*point[8] );
+
+   /* Find which children need to be subdivided */
+
+   mask = 0;
+   for( q = 0; q < 4; q++ ) {
+      int rq = r0 + (q/2)*half;
+      int cq = c0 + (q%2)*half;
+      for( i = 0; i < 4; i++ ) {
+         child[q][i] = point[quadChildCorner[q][i]];
+         c[i] = quad->value + 2*child[q][i];
+         }
+      err = 0.0;
+      if( rq < grid->nlat && cq < grid->nlon ) {
+         err = quadPatchError( grid, rq, cq, half, c );
+         }
+      if( err <= quad->tolerance || half == 1 ) {
+         quad->nleaf++;
+         if( err > quad->maxerr ) quad->maxerr = err;
+         }
+      else {
+         mask |= 1 << q;
+         }
+      }
+
+   first = 0;
+   if( mask ) {
+      first = quadAddBlocks( b, quadMaskCount[mask] );
+      if( first < 0 ) return;
+      }
+   quad->block[k] = ((unsigned int) first << 4) | mask;
+
+   for( q = 0; q < 4 && b->ok; q++ ) {
+      if( ! (mask & (1 << q)) ) continue;
+      quadBuildBlock( b, first++, r0 + (q/2)*half, c0 + (q%2)*half, half,
+                      child[q] );
+      }
+   }
+
+/***********************************************************************
+*  lnzGridQuadCreate
+*
+*  Creates the quadtree.  The corners of the root are the first four 
+*  values.  If the root itself is a leaf the tree has no blocks,
+*  otherwise block 0 holds the children of the root.
+***********************************************************************
+*/
+
+lnzGridQuad *lnzGridQuadCreate( lnzGrid *grid, double tolerance ) {
+   lnzGridQuad *quad;
+   quadBuild b;
+   int corner[4];
+   float *c[4];
+   double err;
+   int ncell, size, i;
+
+   if( ! lnzGridIsOk( grid ) || grid->coverage ) return NULL;
+
+   quad = (lnzGridQuad *) calloc( 1, sizeof(lnzGridQuad) );
+   if( ! quad ) return quad;
+
+   quad->lat0 = grid->lat0;
+   quad->lat1 = grid->lat1;
+   quad->dlat = grid->dlat;
+   quad->lon0 = grid->lon0;
+   quad->lon1 = grid->lon1;
+   quad->dlon = grid->dlon;
+   quad->tolerance = tolerance;
+
+   ncell = grid->nlat > grid->nlon ? grid->nlat-1 : grid->nlon-1;
+   for( quad->depth = 0; (1 << quad->depth) < ncell; quad->depth++ );
+   size = 1 << quad->depth;
+
+   b.grid = grid;
+   b.quad = quad;
+   b.maxblock = 0;
+   b.ok = 1;
+
+   quad->value = (float *) malloc( 4*2*sizeof(float) );
+   if( ! quad->value ) {
+      lnzGridQuadDestroy( quad );
+      return NULL;
+      }
+   for( i = 0; i < 4; i++ ) {
+      corner[i] = i;
+      quadSample( grid, (i/2)*size, (i%2)*size, quad->value + 2*i );
+      c[i] = quad->value + 2*i;
+      }
+
+   err = quadPatchError( grid, 0, 0, size, c );
+   if( err <= tolerance || size == 1 ) {
+      quad->nleaf = 1;
+      quad->maxerr = err;
+      }
+   else if( quadAddBlocks( &b, 1 ) >= 0 ) {
+      quadBuildBlock( &b, 0, 0, 0, size, corner );
+      }
+
+   if( ! b.ok ) {
+      lnzGridQuadDestroy( quad );
+      return NULL;
+      }
+
+   quad->size = (long) quad->nblock*sizeof(unsigned int) +
+                (long) (4 + 5*quad->nblock)*2*sizeof(float);
+   quad->gridsize = (long) grid->nlat*grid->nlon*2*sizeof(float);
+   return quad;
+   }
+
+/***********************************************************************
+*  lnzGridQuadDestroy
+***********************************************************************
+*/
+
+void lnzGridQuadDestroy( lnzGridQuad *quad ) {
+   if( ! quad ) return;
+   if( quad->block ) free( quad->block );
+   if( quad->value ) free( quad->value );
+   free( quad );
+   }
+
+/***********************************************************************
+*  lnzGridQuadShift
+*
+*  Descends the tree to the leaf containing the point, selecting the
+*  child at each level from the position of the point relative to the
+*  centre of the node and keeping track of the child's corners, then 
+*  interpolates the leaf patch.
+***********************************************************************
+*/
+
+void lnzGridQuadShift( lnzGridQuad *quad, double lts, double lns,
+                       double *ltshift, double *lnshift ) {
+   double y, x, size, fy, fx;
+   double r0, c0;
+   int corner[4], point[9];
+   unsigned int blk;
+   int k, q, i, mask, sub;
+   float *c0v, *c1v, *c2v, *c3v;
+
+   size = (double) (1 << quad->depth);
+   y = (lts - quad->lat0)/quad->dlat;
+   x = (lns - quad->lon0)/quad->dlon;
+   if( y < 0.0 ) y = 0.0;
+   if( y > size ) y = size;
+   if( x < 0.0 ) x = 0.0;
+   if( x > size ) x = size;
+
+   for( i = 0; i < 4; i++ ) corner[i] = i;
+   r0 = c0 = 0.0;
+   sub = quad->nblock > 0;
+   k = 0;
+   while( sub ) {
+      blk = quad->block[k];
+      mask = blk & 15;
+      size *= 0.5;
+      q = 0;
+      if( y >= r0 + size ) { r0 += size; q += 2; }
+      if( x >= c0 + size ) { c0 += size; q += 1; }
+      for( i = 0; i < 4; i++ ) point[i] = corner[i];
+      for( i = 0; i < 5; i++ ) point[4+i] = 4 + 5*k + i;
+      for( i = 0; i < 4; i++ ) corner[i] = point[quadChildCorner[q][i]];
+      sub = mask & (1 << q);
+      k = (int) (blk >> 4) + quadMaskCount[mask & ((1 << q) - 1)];
+      }
+
+   c0v = quad->value + 2*corner[0];
+   c1v = quad->value + 2*corner[1];
+   c2v = quad->value + 2*corner[2];
+   c3v = quad->value + 2*corner[3];
+   fy = (y - r0)/size;
+   fx = (x - c0)/size;
+   *ltshift = (c0v[0]*(1-fx) + c1v[0]*fx)*(1-fy) + 
+              (c2v[0]*(1-fx) + c3v[0]*fx)*fy;
+   *lnshift = (c0v[1]*(1-fx) + c1v[1]*fx)*(1-fy) + 
+              (c2v[1]*(1-fx) + c3v[1]*fx)*fy;
+   }
+
+/***********************************************************************
+*  lnzGridQuadTransform
+*
+*  Transforms a point using the quadtree, with the same range checking
+*  and reverse iteration as lnzGridTransform.
+***********************************************************************
+*/
+
+int lnzGridQuadTransform( lnzGridQuad *quad, double lts, double lns,
+                          double *ltd, double *lnd, int reverse ) {
+   double dlat, dlon;
+
+   if( ! quad ) return 0;
+
+   while( lns > quad->lon1 ) lns -= 360.0;
+   while( lns < quad->lon0 ) lns += 360.0;
+
+   if( lns > quad->lon1 || lts < quad->lat0 || lts > quad->lat1 ) return 0;
+
+   lnzGridQuadShift( quad, lts, lns, &dlat, &dlon );
+
+   if( ! reverse ) {
+      lts += dlat;
+      lns += dlon;
+      }
+   else {
+      lnzGridQuadShift( quad, lts - dlat, lns - dlon, &dlat, &dlon );
+      lts -= dlat;
+      lns -= dlon;
+      }
+
+   if( ltd ) *ltd = lts;
+   if( lnd ) *lnd = lns;
+   return 1;
+   }
+
+#ifdef __cplusplus
+};
+#endif
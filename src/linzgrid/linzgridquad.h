@@ -0,0 +1,60 @@
+#ifndef LINZGRIDQUAD_H
+#define LINZGRIDQUAD_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Adaptive quadtree compression of lnzGrid grids.  The grid is divided
+*  into square blocks of cells, each represented by a single bilinear 
+*  patch, and blocks are subdivided only where the patch does not meet
+*  the required tolerance.  The tree is stored as flat arrays with no
+*  pointers, and the patches share the shifts at their corners.
+*
+*  See the comments in linzgridquad.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+typedef struct {
+   double lat0;    /* The minimum latitude of the source grid */
+   double lat1;    /* The maximum latitude of the source grid */
+   double dlat;    /* The latitude increment of the source grid */
+   double lon0;    /* The minimum longitude of the source grid */
+   double lon1;    /* The maximum longitude of the source grid */
+   double dlon;    /* The longitude increment of the source grid */
+   int depth;      /* Depth of the tree - the root covers 2^depth cells */
+   int nblock;     /* The number of blocks of four children */
+   int nleaf;      /* The number of leaves */
+   unsigned int *block;  /* Blocks - 16 times the index of the first 
+                      child block of the subdivided children, plus a mask
+                      of which children (SW, SE, NW, NE) are subdivided */
+   float *value;   /* The shifts at the corners of the root, followed by
+                      the shifts at the S, W, centre, E, and N points of
+                      each block */
+   double tolerance; /* The tolerance used to build the tree (metres) */
+   double maxerr;  /* The maximum error relative to the source grid (metres) */
+   long size;      /* The memory used by the block and value arrays (bytes) */
+   long gridsize;  /* The memory used by the source grid data (bytes) */
+} lnzGridQuad;
+
+lnzGridQuad *lnzGridQuadCreate( lnzGrid *grid, double tolerance );
+
+void     lnzGridQuadDestroy( lnzGridQuad *quad );
+
+void     lnzGridQuadShift( lnzGridQuad *quad, double lts, double lns,
+                           double *ltshift, double *lnshift );
+
+int      lnzGridQuadTransform( lnzGridQuad *quad, double lts, double lns,
+                           double *ltd, double *lnd, int reverse );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
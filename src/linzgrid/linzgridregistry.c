@@ -0,0 +1,203 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module manages a registry of loaded grids, keyed by the source
+*  and target datums (SYSTEM_F and SYSTEM_T in the NTv2 file) of each
+*  grid.  An application that supports several transformations loads
+*  each grid once into the registry, and each transformation then finds
+*  the grid it requires by datum codes rather than holding its own copy.
+*
+*  Grids in the registry are shared, and are reference counted using
+*  lnzGridAddRef and lnzGridRelease.  A grid found in the registry
+*  remains valid until the caller releases it, even if the registry is
+*  destroyed first.  Shared grids must be treated as read only.  The 
+*  batch functions (lnzGridTransformBatch, lnzGridTransformJacobian)
+*  do not modify the grid and may be used from several threads at once.
+*  lnzGridTransform records error messages in the grid, so concurrent
+*  callers may see each other's messages.
+*
+*  Grids are added to the registry while it is being set up.  Adding 
+*  grids is not safe while other threads are finding grids in the same
+*  registry, but finding and releasing grids is.
+*
+***********************************************************************
+*  This module provides the following functions.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGridRegistry *lnzGridRegistryCreate( void );
+*
+*     Creates an empty registry.
+*
+*     Returns
+*        lnzGridRegistry *  The registry, or NULL if it cannot be 
+*                  allocated.
+*
+*----------------------------------------------------------------------
+*
+*  void lnzGridRegistryDestroy( lnzGridRegistry *registry );
+*
+*     Destroys the registry, releasing its reference to each grid.
+*     Grids that are still held by other users are not destroyed until
+*     they are released.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridRegistryAdd( lnzGridRegistry *registry, lnzGrid *grid );
+*
+*     Adds a grid to the registry.  The registry takes ownership of the 
+*     grid, which must have been allocated with malloc (as by 
+*     lnzGridCreateFromNTv2Asc, lnzGridCreate, or a generated grid
+*     source file) and must not be destroyed by the caller.
+*
+*     Parameters
+*        registry  The registry
+*        grid      The grid to add
+*
+*     Returns
+*        int       1 (true) if the grid is added.  Otherwise 0 (false),
+*                  in which case the grid is not added and remains owned
+*                  by the caller.  This happens if the grid is not valid,
+*                  has no datum codes, if a grid for the same datums is
+*                  already registered, or if memory cannot be allocated.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGrid *lnzGridRegistryFind( lnzGridRegistry *registry, 
+*                                const char *datum0, const char *datum1,
+*                                int *reverse );
+*
+*     Finds the grid for transforming from one datum to another.  Datum
+*     codes are compared without regard to case.  A grid from datum1 to
+*     datum0 is used if there is no grid from datum0 to datum1, in which
+*     case the transformation must be applied in reverse.
+*
+*     Parameters
+*        registry  The registry
+*        datum0    The source datum code
+*        datum1    The target datum code
+*        reverse   Returns 0 if the grid is to be applied forwards, and
+*                  1 if it is to be applied in reverse.  May be NULL.
+*
+*     Returns
+*        lnzGrid * The grid, with a reference added for the caller, who
+*                  must release it with lnzGridRelease.  Returns NULL if 
+*                  no grid is registered for the datums.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "linzgridregistry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+*  registryDatumMatch
+*
+*  Compares two datum codes without regard to case.
+***********************************************************************
+*/
+
+static int registryDatumMatch( const char *d0, const char *d1 ) {
+   for( ; *d0 && *d1; d0++, d1++ ) {
+      if( toupper((unsigned char) *d0) != toupper((unsigned char) *d1) ) {
+         return 0;
+         }
+      }
+   return *d0 == *d1;
+   }
+
+/***********************************************************************
+*  lnzGridRegistryCreate
+***********************************************************************
+*/
+
+lnzGridRegistry *lnzGridRegistryCreate( void ) {
+   return (lnzGridRegistry *) calloc( 1, sizeof(lnzGridRegistry) );
+   }
+
+/***********************************************************************
+*  lnzGridRegistryDestroy
+***********************************************************************
+*/
+
+void lnzGridRegistryDestroy( lnzGridRegistry *registry ) {
+   int ng;
+   if( ! registry ) return;
+   for( ng = 0; ng < registry->ngrid; ng++ ) {
+      lnzGridRelease( registry->grid[ng] );
+      }
+   if( registry->grid ) free( registry->grid );
+   free( registry );
+   }
+
+/***********************************************************************
+*  lnzGridRegistryAdd
+***********************************************************************
+*/
+
+int lnzGridRegistryAdd( lnzGridRegistry *registry, lnzGrid *grid ) {
+   int ng;
+
+   if( ! registry || ! lnzGridIsOk( grid ) ) return 0;
+   if( ! grid->datum0[0] || ! grid->datum1[0] ) return 0;
+
+   for( ng = 0; ng < registry->ngrid; ng++ ) {
+      lnzGrid *g = registry->grid[ng];
+      if( registryDatumMatch( g->datum0, grid->datum0 ) &&
+          registryDatumMatch( g->datum1, grid->datum1 ) ) return 0;
+      }
+
+   if( registry->ngrid >= registry->maxgrid ) {
+      lnzGrid **grids;
+      int maxgrid = registry->maxgrid ? registry->maxgrid*2 : 4;
+      grids = (lnzGrid **) realloc( registry->grid, maxgrid*sizeof(lnzGrid *) );
+      if( ! grids ) return 0;
+      registry->grid = grids;
+      registry->maxgrid = maxgrid;
+      }
+
+   registry->grid[registry->ngrid++] = lnzGridAddRef( grid );
+   return 1;
+   }
+
+/***********************************************************************
+*  lnzGridRegistryFind
+*
+*  Searches first for a grid in the requested direction, then for one
+*  in the reverse direction.
+***********************************************************************
+*/
+
+lnzGrid *lnzGridRegistryFind( lnzGridRegistry *registry, 
+                              const char *datum0, const char *datum1,
+                              int *reverse ) {
+   int ng, rev;
+
+   if( reverse ) *reverse = 0;
+   if( ! registry || ! datum0 || ! datum1 ) return NULL;
+
+   for( rev = 0; rev < 2; rev++ ) {
+      for( ng = 0; ng < registry->ngrid; ng++ ) {
+         lnzGrid *g = registry->grid[ng];
+         if( registryDatumMatch( g->datum0, rev ? datum1 : datum0 ) &&
+             registryDatumMatch( g->datum1, rev ? datum0 : datum1 ) ) {
+            if( reverse ) *reverse = rev;
+            return lnzGridAddRef( g );
+            }
+         }
+      }
+   return NULL;
+   }
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,42 @@
+#ifndef LINZGRIDREGISTRY_H
+#define LINZGRIDREGISTRY_H
+/***********************************************************************
+*
+*  Description:
+*
+*  A registry of loaded grids, keyed by the source and target datums of
+*  each grid.  Grids in the registry are reference counted and shared
+*  between all of the transformations that use them.
+*
+*  See the comments in linzgridregistry.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+typedef struct {
+   int ngrid;       /* The number of grids in the registry */
+   int maxgrid;     /* The number of grids allocated */
+   lnzGrid **grid;  /* The grids, each holding a reference */
+} lnzGridRegistry;
+
+lnzGridRegistry *lnzGridRegistryCreate( void );
+
+void     lnzGridRegistryDestroy( lnzGridRegistry *registry );
+
+int      lnzGridRegistryAdd( lnzGridRegistry *registry, lnzGrid *grid );
+
+lnzGrid *lnzGridRegistryFind( lnzGridRegistry *registry, 
+                              const char *datum0, const char *datum1,
+                              int *reverse );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,361 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  This module publishes grids into named POSIX shared memory segments,
+*  and attaches to them from other processes.  A pool of worker 
+*  processes can then share a single copy of the grid data, rather than
+*  each loading its own copy from the grid file.
+*
+*  The segment holds a header describing the grid followed by the grid
+*  data in the flat layout used by the loader, with the rows stored 
+*  consecutively from the minimum latitude, and then the coverage bitmap
+*  if the grid has missing data.  The header records a format version,
+*  the sizes of each part, and a checksum of the header and data, which
+*  are all verified when a process attaches.  The magic number identifying the
+*  segment is written last, so a process never attaches to a segment 
+*  that is only partly written.
+*
+*  Attached grids are mapped read only.  They may be used with all of
+*  the transformation functions, but not modified (for example with 
+*  lnzGridSetNoData).  The segment layout depends on the compiler and
+*  architecture, so it can only be shared between processes built the
+*  same way.  This is checked by the header size and version.
+*
+***********************************************************************
+*  This module provides the following functions.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridShmPublish( lnzGrid *grid, const char *name );
+*
+*     Copies a grid into a new shared memory segment.  Any existing 
+*     segment with the same name is first removed.  Processes already
+*     attached to the old segment continue to use it.
+*
+*     Parameters
+*        grid      The grid to publish
+*        name      The name of the segment, as for shm_open (for 
+*                  example "/nzgd2kgrid")
+*
+*     Returns
+*        int       1 (true) if the grid is published, otherwise 0 
+*                  (false), in which case lnzGridLastError returns the
+*                  reason.
+*
+*----------------------------------------------------------------------
+*
+*  lnzGrid *lnzGridShmAttach( const char *name );
+*
+*     Attaches read only to a grid published in shared memory.
+*
+*     Parameters
+*        name      The name of the segment
+*
+*     Returns
+*        lnzGrid * A lnzGrid object handle, which should be tested with
+*                  lnzGridIsOk as for lnzGridCreateFromNTv2Asc.  The 
+*                  grid is detached by lnzGridDestroy.  Returns NULL if
+*                  there is insufficient memory for the handle.
+*
+*----------------------------------------------------------------------
+*
+*  int lnzGridShmUnlink( const char *name );
+*
+*     Removes the name of a shared memory segment.  The segment memory
+*     is released when the last process using it detaches.  Returns 1
+*     (true) if successful, 0 (false) otherwise.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "linzgridshm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHM_MAGIC "LNZGRID"
+#define SHM_ALIGN 64
+
+/* Header at the start of the segment */
+
+typedef struct {
+   char magic[8];
+   long version;
+   long headersize;
+   long dataoffset;
+   long datasize;
+   long coveragesize;
+   unsigned int checksum;
+   int nlat;
+   int nlon;
+   double lat0;
+   double lat1;
+   double dlat;
+   double lon0;
+   double lon1;
+   double dlon;
+   char datum0[MAX_DATUM_LEN];
+   char datum1[MAX_DATUM_LEN];
+   int usefallback;
+   double fbmargin;
+   lnzHelmert fallback;
+   } shmHeader;
+
+/***********************************************************************
+*  shmChecksum
+*
+*  Calculates a 32 bit FNV-1a checksum of a segment, covering the header
+*  (excluding the magic number and checksum) and the data following it.
+***********************************************************************
+*/
+
+static unsigned int shmChecksumBlock( unsigned int sum, 
+                                      const unsigned char *data, long size ) {
+   for( ; size--; data++ ) {
+      sum ^= *data;
+      sum *= 16777619U;
+      }
+   return sum;
+   }
+
+static unsigned int shmChecksum( const unsigned char *seg, long dataoffset,
+                                 long size ) {
+   shmHeader hdr;
+   memcpy( &hdr, seg, sizeof(shmHeader) );
+   memset( hdr.magic, 0, sizeof(hdr.magic) );
+   hdr.checksum = 0;
+   return shmChecksumBlock( 
+             shmChecksumBlock( 2166136261U, (unsigned char *) &hdr, sizeof(hdr) ),
+             seg + dataoffset, size );
+   }
+
+/***********************************************************************
+*  shmLayout
+*
+*  Calculates the offset of the grid data and the total size of the
+*  segment for a grid.
+***********************************************************************
+*/
+
+static long shmLayout( lnzGrid *grid, long *dataoffset, long *datasize,
+                       long *coveragesize ) {
+   *dataoffset = ((sizeof(shmHeader) + SHM_ALIGN - 1)/SHM_ALIGN)*SHM_ALIGN;
+   *datasize = (long) grid->nlat * grid->nlon * 2 * sizeof(float);
+   *coveragesize = 0;
+   if( grid->coverage ) {
+      *coveragesize = ((long) (grid->nlat-1)*(grid->nlon-1) + 7)/8;
+      }
+   return *dataoffset + *datasize + *coveragesize;
+   }
+
+/***********************************************************************
+*  lnzGridShmPublish
+***********************************************************************
+*/
+
+int lnzGridShmPublish( lnzGrid *grid, const char *name ) {
+   shmHeader *hdr;
+   unsigned char *seg;
+   long dataoffset, datasize, coveragesize, size, rowsize;
+   int fd, nlt;
+
+   if( ! lnzGridIsOk( grid ) ) return 0;
+
+   size = shmLayout( grid, &dataoffset, &datasize, &coveragesize );
+
+   shm_unlink( name );
+   fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, 0644 );
+   if( fd < 0 ) {
+      strcpy( grid->errmsg, "Cannot create shared memory segment" );
+      return 0;
+      }
+   if( ftruncate( fd, size ) != 0 ) {
+      close( fd );
+      shm_unlink( name );
+      strcpy( grid->errmsg, "Cannot allocate shared memory segment" );
+      return 0;
+      }
+   seg = (unsigned char *) mmap( NULL, size, PROT_READ | PROT_WRITE, 
+                                 MAP_SHARED, fd, 0 );
+   close( fd );
+   if( seg == (unsigned char *) MAP_FAILED ) {
+      shm_unlink( name );
+      strcpy( grid->errmsg, "Cannot map shared memory segment" );
+      return 0;
+      }
+
+   /* Copy the grid data and coverage */
+
+   rowsize = (long) grid->nlon * 2 * sizeof(float);
+   for( nlt = 0; nlt < grid->nlat; nlt++ ) {
+      memcpy( seg + dataoffset + nlt*rowsize, grid->grid[nlt], rowsize );
+      }
+   if( coveragesize ) {
+      memcpy( seg + dataoffset + datasize, grid->coverage, coveragesize );
+      }
+
+   /* Fill in the header, with the magic number last */
+
+   hdr = (shmHeader *) seg;
+   memset( hdr, 0, sizeof(shmHeader) );
+   hdr->version = LNZGRID_SHM_VERSION;
+   hdr->headersize = sizeof(shmHeader);
+   hdr->dataoffset = dataoffset;
+   hdr->datasize = datasize;
+   hdr->coveragesize = coveragesize;
+   hdr->nlat = grid->nlat;
+   hdr->nlon = grid->nlon;
+   hdr->lat0 = grid->lat0;
+   hdr->lat1 = grid->lat1;
+   hdr->dlat = grid->dlat;
+   hdr->lon0 = grid->lon0;
+   hdr->lon1 = grid->lon1;
+   hdr->dlon = grid->dlon;
+   strcpy( hdr->datum0, grid->datum0 );
+   strcpy( hdr->datum1, grid->datum1 );
+   hdr->usefallback = grid->usefallback;
+   hdr->fbmargin = grid->fbmargin;
+   hdr->fallback = grid->fallback;
+   hdr->checksum = shmChecksum( seg, dataoffset, datasize + coveragesize );
+
+   __sync_synchronize();
+   memcpy( hdr->magic, SHM_MAGIC, sizeof(hdr->magic) );
+
+   munmap( seg, size );
+   return 1;
+   }
+
+/***********************************************************************
+*  shmRelease
+*
+*  Release function for attached grids, called by lnzGridDestroy.
+***********************************************************************
+*/
+
+static void shmRelease( lnzGrid *grid ) {
+   if( grid->mapping ) munmap( grid->mapping, grid->maplen );
+   if( grid->grid ) free( grid->grid );
+   grid->mapping = NULL;
+   grid->maplen = 0;
+   grid->grid = NULL;
+   grid->coverage = NULL;
+   }
+
+/***********************************************************************
+*  lnzGridShmAttach
+***********************************************************************
+*/
+
+lnzGrid *lnzGridShmAttach( const char *name ) {
+   lnzGrid *grid;
+   shmHeader *hdr;
+   unsigned char *seg;
+   struct stat st;
+   long size, dataoffset, datasize, coveragesize;
+   int fd, nlt;
+
+   grid = (lnzGrid *) calloc( 1, sizeof(lnzGrid) );
+   if( ! grid ) return grid;
+
+   fd = shm_open( name, O_RDONLY, 0 );
+   if( fd < 0 ) {
+      strcpy( grid->errmsg, "Cannot open shared memory segment" );
+      return grid;
+      }
+   if( fstat( fd, &st ) != 0 || st.st_size < (long) sizeof(shmHeader) ) {
+      close( fd );
+      strcpy( grid->errmsg, "Shared memory segment is too small" );
+      return grid;
+      }
+   size = st.st_size;
+   seg = (unsigned char *) mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+   close( fd );
+   if( seg == (unsigned char *) MAP_FAILED ) {
+      strcpy( grid->errmsg, "Cannot map shared memory segment" );
+      return grid;
+      }
+
+   grid->mapping = seg;
+   grid->maplen = size;
+   grid->release = shmRelease;
+
+   /* Check the header */
+
+   hdr = (shmHeader *) seg;
+   if( memcmp( hdr->magic, SHM_MAGIC, sizeof(hdr->magic) ) != 0 ) {
+      strcpy( grid->errmsg, "Shared memory segment does not contain a grid" );
+      return grid;
+      }
+   __sync_synchronize();
+   if( hdr->version != LNZGRID_SHM_VERSION ||
+       hdr->headersize != (long) sizeof(shmHeader) ) {
+      strcpy( grid->errmsg, "Shared memory grid has an incompatible version" );
+      return grid;
+      }
+   grid->lat0 = hdr->lat0;
+   grid->lat1 = hdr->lat1;
+   grid->dlat = hdr->dlat;
+   grid->lon0 = hdr->lon0;
+   grid->lon1 = hdr->lon1;
+   grid->dlon = hdr->dlon;
+   grid->nlat = hdr->nlat;
+   grid->nlon = hdr->nlon;
+   if( grid->nlat < 2 || grid->nlon < 2 ||
+       shmLayout( grid, &dataoffset, &datasize, &coveragesize ) > size ||
+       hdr->dataoffset != dataoffset || hdr->datasize != datasize ||
+       (hdr->coveragesize != 0 && hdr->coveragesize != coveragesize) ) {
+      strcpy( grid->errmsg, "Shared memory grid has inconsistent dimensions" );
+      return grid;
+      }
+   coveragesize = hdr->coveragesize;
+   if( hdr->checksum != shmChecksum( seg, dataoffset, datasize + coveragesize ) ) {
+      strcpy( grid->errmsg, "Shared memory grid checksum is invalid" );
+      return grid;
+      }
+
+   /* Set up the grid to use the segment data */
+
+   grid->grid = (float **) malloc( grid->nlat * sizeof(float *) );
+   if( ! grid->grid ) {
+      strcpy( grid->errmsg, "Cannot allocate sufficient memory for grid" );
+      return grid;
+      }
+   for( nlt = 0; nlt < grid->nlat; nlt++ ) {
+      grid->grid[nlt] = (float *) (seg + dataoffset) + (size_t) nlt * grid->nlon * 2;
+      }
+   if( coveragesize ) grid->coverage = seg + dataoffset + datasize;
+
+   memcpy( grid->datum0, hdr->datum0, MAX_DATUM_LEN );
+   memcpy( grid->datum1, hdr->datum1, MAX_DATUM_LEN );
+   grid->datum0[MAX_DATUM_LEN-1] = 0;
+   grid->datum1[MAX_DATUM_LEN-1] = 0;
+   grid->usefallback = hdr->usefallback;
+   grid->fbmargin = hdr->fbmargin;
+   grid->fallback = hdr->fallback;
+   grid->gridok = 1;
+
+   return grid;
+   }
+
+/***********************************************************************
+*  lnzGridShmUnlink
+***********************************************************************
+*/
+
+int lnzGridShmUnlink( const char *name ) {
+   return shm_unlink( name ) == 0;
+   }
+
+#ifdef __cplusplus
+};
+#endif
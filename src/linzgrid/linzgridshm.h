@@ -0,0 +1,33 @@
+#ifndef LINZGRIDSHM_H
+#define LINZGRIDSHM_H
+/***********************************************************************
+*
+*  Description:
+*
+*  Publishing of loaded grids into named POSIX shared memory segments,
+*  so that several processes can use one copy of the grid data.
+*
+*  See the comments in linzgridshm.c for details of these functions.
+*
+***********************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "linzgrid.h"
+
+#define LNZGRID_SHM_VERSION 1
+
+int      lnzGridShmPublish( lnzGrid *grid, const char *name );
+
+lnzGrid *lnzGridShmAttach( const char *name );
+
+int      lnzGridShmUnlink( const char *name );
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
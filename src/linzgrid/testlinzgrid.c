@@ -34,6 +34,11 @@
 
 #include "linzgrid.h"
 #include "linzgridload.h"
+#include "linzgridpyramid.h"
+#include "linzgridquad.h"
+#include "linzgridflat.h"
+#include "linzgridshm.h"
+#include "linzgridhuge.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,10 +52,252 @@ extern "C" {
 * degrees on each line.  The program will write the converted latitude
 * and longitude to the standard output channel.  The program takes one 
 * option -r, which if present causes the reverse transformation to be
-* applied.
+* applied, and an option -b, which reads the entire data file and 
+* converts it with a single call to lnzGridTransformBatch.  The option
+* -f additionally applies the NZGD1949 to NZGD2000 Helmert transformation
+* to points outside the grid, and -m margin applies it only to points 
+* within the margin (degrees) of the grid.  The option -t tolerance builds a grid 
+* pyramid and uses the smallest level accurate to the tolerance (metres),
+* and -c tolerance uses a quadtree compressed grid built to the tolerance.
+* The option -s name publishes the grid to the named shared memory 
+* segment, and uses the grid attached from the segment.  The option -H 
+* backs the grid data with huge pages where possible.  The option -j 
+* lists the Jacobian of the forward and reverse transformations at each
+* point from lnzGridTransformJacobian, and checks it against finite
+* differences of lnzGridTransformBatch.  The option -F flattens a two 
+* level hierarchy built from the grid (see flatten_grid) and uses the 
+* flattened grid.
 **********************************************************************
 */
 
+static int read_batch( FILE *d, double **plt, double **pln, 
+                       unsigned char **pvalid ) {
+   char buf[80];
+   double *lt, *ln;
+   unsigned char *valid;
+   int npt, maxpt;
+
+   npt = 0;
+   maxpt = 0;
+   lt = ln = NULL;
+   valid = NULL;
+
+   while( fgets(buf,80,d) ) {
+       if( npt >= maxpt ) {
+           maxpt = maxpt ? maxpt*2 : 256;
+           lt = (double *) realloc( lt, maxpt*sizeof(double) );
+           ln = (double *) realloc( ln, maxpt*sizeof(double) );
+           valid = (unsigned char *) realloc( valid, maxpt );
+           if( ! lt || ! ln || ! valid ) {
+               fprintf(stderr,"Error: Not enough memory for batch data\n");
+               return -1;
+               }
+           }
+       valid[npt] = sscanf(buf,"%lf%lf",lt+npt,ln+npt) == 2;
+       if( ! valid[npt] ) { lt[npt] = ln[npt] = 0.0; }
+       npt++;
+       }
+
+   *plt = lt;
+   *pln = ln;
+   *pvalid = valid;
+   return npt;
+   }
+
+static int transform_batch( lnzGrid *grid, FILE *d, FILE *o, int reverse ) {
+   double *lt, *ln;
+   unsigned char *valid, *status;
+   int npt, i;
+
+   npt = read_batch( d, &lt, &ln, &valid );
+   if( npt < 0 ) return 0;
+
+   status = (unsigned char *) malloc( npt ? npt : 1 );
+   if( ! status ) {
+       fprintf(stderr,"Error: Not enough memory for batch data\n");
+       return 0;
+       }
+
+   lnzGridTransformBatch( grid, npt, lt, ln, lt, ln, reverse, status );
+
+   for( i = 0; i < npt; i++ ) {
+       if( ! valid[i] ) {
+           fprintf(o,"Error: Invalid input data\n");
+           }
+       else if( status[i] == LNZGRID_PT_GRID ) {
+           fprintf(o,"%12.8f %12.8f\n",lt[i],ln[i]);
+           }
+       else if( status[i] == LNZGRID_PT_HELMERT ) {
+           fprintf(o,"%12.8f %12.8f (Helmert fallback)\n",lt[i],ln[i]);
+           }
+       else {
+           fprintf(o,"Error: Point is outside the range of the grid\n");
+           }
+       }
+
+   free(lt);
+   free(ln);
+   free(valid);
+   free(status);
+   return 1;
+   }
+
+/* Estimates the Jacobian of the transformation at a point by finite
+   differences.  Central differences are used where the points either
+   side are on the grid, otherwise a one sided difference on the side 
+   that is (so that points on the edge of the grid use the cell inside
+   it).  Points off the grid are given the identity matrix, as for
+   lnzGridTransformJacobian. */
+
+#define JACOBIAN_STEP 1.0e-5
+
+static void jacobian_fd( lnzGrid *grid, double lt, double ln, int reverse,
+                         double *jac ) {
+   double lts[5], lns[5], ltd[5], lnd[5];
+   unsigned char status[5];
+   int k;
+
+   for( k = 0; k < 5; k++ ) { lts[k] = lt; lns[k] = ln; }
+   lts[1] += JACOBIAN_STEP;  lts[2] -= JACOBIAN_STEP;
+   lns[3] += JACOBIAN_STEP;  lns[4] -= JACOBIAN_STEP;
+   lnzGridTransformBatch( grid, 5, lts, lns, ltd, lnd, reverse, status );
+
+   jac[0] = 1.0; jac[1] = 0.0;
+   jac[2] = 0.0; jac[3] = 1.0;
+   if( status[0] != LNZGRID_PT_GRID ) return;
+
+   for( k = 0; k < 2; k++ ) {
+       int kp = 2*k+1, km = 2*k+2;
+       double step = JACOBIAN_STEP;
+       if( status[kp] != LNZGRID_PT_GRID ) { kp = 0; step /= 2.0; }
+       if( status[km] != LNZGRID_PT_GRID ) { km = 0; step /= 2.0; }
+       if( kp == km ) continue;
+       jac[k] = (ltd[kp]-ltd[km])/(2.0*step);
+       jac[k+2] = (lnd[kp]-lnd[km])/(2.0*step);
+       }
+   }
+
+/* Lists the Jacobian of the forward and reverse transformations at each 
+   point, and checks it against the finite difference estimate */
+
+static int transform_jacobian( lnzGrid *grid, FILE *d, FILE *o ) {
+   double *lt, *ln, *ltd, *lnd, *jac;
+   unsigned char *valid, *status;
+   int npt, i, k, reverse;
+
+   npt = read_batch( d, &lt, &ln, &valid );
+   if( npt < 0 ) return 0;
+
+   ltd = (double *) malloc( (npt ? npt : 1)*6*sizeof(double) );
+   status = (unsigned char *) malloc( npt ? npt : 1 );
+   if( ! ltd || ! status ) {
+       fprintf(stderr,"Error: Not enough memory for batch data\n");
+       return 0;
+       }
+   lnd = ltd + npt;
+   jac = lnd + npt;
+
+   for( reverse = 0; reverse < 2; reverse++ ) {
+       fprintf(o,"%s transformation Jacobian\n", reverse ? "Reverse" : "Forward");
+       lnzGridTransformJacobian( grid, npt, lt, ln, ltd, lnd, jac, 
+                                 reverse, status );
+       for( i = 0; i < npt; i++ ) {
+           double fd[4], diff;
+           if( ! valid[i] ) {
+               fprintf(o,"Error: Invalid input data\n");
+               continue;
+               }
+           jacobian_fd( grid, lt[i], ln[i], reverse, fd );
+           diff = 0.0;
+           for( k = 0; k < 4; k++ ) {
+               if( fabs(jac[4*i+k]-fd[k]) > diff ) diff = fabs(jac[4*i+k]-fd[k]);
+               }
+           fprintf(o,"%12.8f %12.8f %13.10f %13.10f %13.10f %13.10f %s %s\n",
+               ltd[i], lnd[i], jac[4*i], jac[4*i+1], jac[4*i+2], jac[4*i+3],
+               status[i] == LNZGRID_PT_GRID ? "grid" : "outside",
+               diff < 1.0e-7 ? "ok" : "differs from finite differences" );
+           }
+       }
+
+   free(lt);
+   free(ln);
+   free(valid);
+   free(ltd);
+   free(status);
+   return 1;
+   }
+
+/* Copies the nodes of the grid between the given latitudes and 
+   longitudes (rounded to the nearest nodes) into a new grid */
+
+static lnzGrid *crop_grid( lnzGrid *grid, double lat0, double lat1,
+                           double lon0, double lon1 ) {
+   lnzGrid *crop;
+   int nlt0, nln0, nlat, nlon, nlt;
+
+   nlt0 = (int) floor( (lat0 - grid->lat0)/grid->dlat + 0.5 );
+   nln0 = (int) floor( (lon0 - grid->lon0)/grid->dlon + 0.5 );
+   nlat = (int) floor( (lat1 - lat0)/grid->dlat + 0.5 ) + 1;
+   nlon = (int) floor( (lon1 - lon0)/grid->dlon + 0.5 ) + 1;
+   if( nlt0 < 0 || nln0 < 0 || nlt0+nlat > grid->nlat || 
+       nln0+nlon > grid->nlon ) return NULL;
+
+   crop = lnzGridCreate( grid->lat0 + nlt0*grid->dlat, grid->dlat, nlat,
+                         grid->lon0 + nln0*grid->dlon, grid->dlon, nlon );
+   if( ! lnzGridIsOk( crop ) ) return crop;
+   strcpy( crop->datum0, grid->datum0 );
+   strcpy( crop->datum1, grid->datum1 );
+   for( nlt = 0; nlt < nlat; nlt++ ) {
+       memcpy( crop->grid[nlt], grid->grid[nlt0+nlt] + 2*nln0, 
+               2*nlon*sizeof(float) );
+       }
+   return crop;
+   }
+
+/* Flattens a hierarchy built from the grid.  The parent is the grid 
+   subsampled at four times its spacing (level 2 of a grid pyramid), and
+   the child is the part of the grid from latitude -42 to -40 and 
+   longitude 172 to 175.  The extent flattened is that of the child 
+   expanded by one degree, so the flattened grid has the spacing of the
+   child and takes the parent's shifts around it. */
+
+static lnzGrid *flatten_grid( lnzGrid *grid, int quiet ) {
+   lnzGridPyramid *pyramid;
+   lnzGrid *hierarchy[2];
+   lnzGrid *flat;
+   long size;
+   double maxerr;
+
+   pyramid = lnzGridPyramidCreate( grid, 3 );
+   if( ! pyramid || pyramid->nlevel < 3 ) {
+       lnzGridPyramidDestroy( pyramid );
+       return NULL;
+       }
+   hierarchy[0] = pyramid->level[2];
+   hierarchy[1] = crop_grid( grid, -42.0, -40.0, 172.0, 175.0 );
+   if( ! lnzGridIsOk( hierarchy[1] ) ) {
+       if( hierarchy[1] ) { lnzGridDestroy( hierarchy[1] ); free( hierarchy[1] ); }
+       lnzGridPyramidDestroy( pyramid );
+       return NULL;
+       }
+
+   flat = lnzGridFlatten( hierarchy, 2, -43.0, -39.0, 171.0, 176.0, 
+                          &size, &maxerr );
+
+   if( ! quiet && lnzGridIsOk( flat ) ) {
+       printf("Flattened grid\n");
+       printf("  parent = %d x %d\n", hierarchy[0]->nlat, hierarchy[0]->nlon);
+       printf("  child = %d x %d\n", hierarchy[1]->nlat, hierarchy[1]->nlon);
+       printf("  size = %ld bytes\n", size);
+       printf("  max error = %.4f m\n", maxerr);
+       }
+
+   lnzGridDestroy( hierarchy[1] );
+   free( hierarchy[1] );
+   lnzGridPyramidDestroy( pyramid );
+   return flat;
+   }
+
 int main( int argc, char *argv[] ) {
    char *gridfile;
    char *datafile;
@@ -61,11 +308,37 @@ int main( int argc, char *argv[] ) {
    char buf[80];
    int reverse;
    int quiet;
+   int batch;
+   int fallback;
+   double margin;
+   int jacobian;
+   double tolerance;
+   lnzGridPyramid *pyramid;
+   double quadtol;
+   lnzGridQuad *quad;
+   lnzGrid *flat;
+   lnzGrid *source;
+   int flatten;
+   char *shmname;
+   int hugepages;
    double lt0, ln0;
    double lt1, ln1;
 
    reverse = 0;
    quiet = 0;
+   batch = 0;
+   fallback = 0;
+   margin = -1.0;
+   jacobian = 0;
+   tolerance = 0.0;
+   pyramid = NULL;
+   quadtol = 0.0;
+   quad = NULL;
+   flat = NULL;
+   source = NULL;
+   flatten = 0;
+   shmname = NULL;
+   hugepages = 0;
 
    while( argc > 1 && argv[1][0] == '-' ) {
       if( strcmp(argv[1],"-r") == 0 ) {
@@ -74,6 +347,44 @@ int main( int argc, char *argv[] ) {
       else if (strcmp(argv[1],"-q") == 0 ) {
          quiet = 1;
          }
+      else if (strcmp(argv[1],"-b") == 0 ) {
+         batch = 1;
+         }
+      else if (strcmp(argv[1],"-f") == 0 ) {
+         batch = 1;
+         fallback = 1;
+         }
+      else if (strcmp(argv[1],"-m") == 0 && argc > 2 ) {
+         batch = 1;
+         fallback = 1;
+         margin = atof(argv[2]);
+         argc--;
+         argv++;
+         }
+      else if (strcmp(argv[1],"-F") == 0 ) {
+         flatten = 1;
+         }
+      else if (strcmp(argv[1],"-j") == 0 ) {
+         jacobian = 1;
+         }
+      else if (strcmp(argv[1],"-c") == 0 && argc > 2 ) {
+         quadtol = atof(argv[2]);
+         argc--;
+         argv++;
+         }
+      else if (strcmp(argv[1],"-H") == 0 ) {
+         hugepages = 1;
+         }
+      else if (strcmp(argv[1],"-s") == 0 && argc > 2 ) {
+         shmname = argv[2];
+         argc--;
+         argv++;
+         }
+      else if (strcmp(argv[1],"-t") == 0 && argc > 2 ) {
+         tolerance = atof(argv[2]);
+         argc--;
+         argv++;
+         }
       else {
          fprintf(stderr,"Invalid switch %s to linzgrid\n",argv[1]);
          return 1;
@@ -83,7 +394,7 @@ int main( int argc, char *argv[] ) {
       }
 
    if( argc != 3 && argc != 4 ) {
-      fprintf(stderr,"Syntax: linzgrid [-r] [-q] ntv2_grid_file data_file [output_file]\n");
+      fprintf(stderr,"Syntax: linzgrid [-r] [-q] [-b] [-f] [-m margin] [-j] [-F] [-t tolerance] [-c tolerance] [-s name] [-H] ntv2_grid_file data_file [output_file]\n");
       return 1;
       }
 
@@ -98,6 +409,88 @@ int main( int argc, char *argv[] ) {
        lnzGridDestroy( grid );
        return 2;    
        }
+
+   if( fallback ) {
+       lnzGridSetHelmertFallback( grid, lnzGridHelmertNzgd49(), margin );
+       }
+
+   if( shmname ) {
+       if( ! lnzGridShmPublish( grid, shmname ) ) {
+           fprintf(stderr,"Error: %s\n", lnzGridLastError(grid) );
+           lnzGridDestroy( grid );
+           return 2;
+           }
+       lnzGridDestroy( grid );
+       free( grid );
+       grid = lnzGridShmAttach( shmname );
+       lnzGridShmUnlink( shmname );
+       if( ! lnzGridIsOk( grid ) ) {
+           fprintf(stderr,"Error: %s\n", lnzGridLastError(grid) );
+           lnzGridDestroy( grid );
+           return 2;
+           }
+       }
+
+   if( hugepages ) {
+       static char *hugetype[] = { "none", "reserved", "transparent" };
+       hugepages = lnzGridUseHugePages( grid );
+       if( ! quiet ) printf("Huge pages: %s\n", hugetype[hugepages] );
+       }
+
+   if( flatten ) {
+       flat = flatten_grid( grid, quiet );
+       if( ! lnzGridIsOk( flat ) ) {
+           fprintf(stderr,"Error: Cannot flatten grid\n");
+           if( flat ) { lnzGridDestroy( flat ); free( flat ); }
+           lnzGridDestroy( grid );
+           return 2;
+           }
+       source = grid;
+       grid = flat;
+       }
+
+   if( tolerance > 0.0 ) {
+       int lv;
+       pyramid = lnzGridPyramidCreate( grid, LNZGRID_MAX_LEVELS );
+       if( ! pyramid ) {
+           fprintf(stderr,"Error: Cannot create grid pyramid\n");
+           lnzGridDestroy( grid );
+           return 2;
+           }
+       if( ! quiet ) {
+           printf("Grid pyramid\n");
+           for( lv = 0; lv < pyramid->nlevel; lv++ ) {
+               printf("  level %d: %d x %d  %ld bytes  max error %.4f m\n", lv, 
+                   pyramid->level[lv]->nlat, pyramid->level[lv]->nlon,
+                   pyramid->size[lv], pyramid->maxerr[lv] );
+               }
+           }
+       grid = lnzGridPyramidSelect( pyramid, tolerance );
+       if( ! quiet ) {
+           for( lv = 0; pyramid->level[lv] != grid; lv++ );
+           printf("  selected level %d for tolerance %.4f m\n", lv, tolerance );
+           }
+       }
+
+   if( quadtol > 0.0 ) {
+       quad = lnzGridQuadCreate( grid, quadtol );
+       if( ! quad ) {
+           fprintf(stderr,"Error: Cannot create grid quadtree\n");
+           lnzGridDestroy( grid );
+           return 2;
+           }
+       if( ! quiet ) {
+           printf("Grid quadtree\n");
+           printf("  depth = %d\n", quad->depth);
+           printf("  blocks = %d\n", quad->nblock);
+           printf("  leaves = %d\n", quad->nleaf);
+           printf("  size = %ld bytes\n", quad->size);
+           printf("  grid size = %ld bytes\n", quad->gridsize);
+           printf("  compression ratio = %.2f\n", 
+                  (double) quad->gridsize/quad->size);
+           printf("  max error = %.4f m\n", quad->maxerr);
+           }
+       }
  
    if( ! quiet ) {
       printf("Grid definition\n");
@@ -133,11 +526,25 @@ int main( int argc, char *argv[] ) {
       d = stdin;
       }
 
-   if( d && o ) {
+   if( d && o && jacobian ) {
+       transform_jacobian( grid, d, o );
+       }
+   else if( d && o && batch ) {
+       transform_batch( grid, d, o, reverse );
+       }
+   else if( d && o ) {
        while( fgets(buf,80,d) ) {
            if( sscanf(buf,"%lf%lf",&lt0,&ln0) != 2 ) {
                fprintf(o,"Error: Invalid input data\n");
                }
+           else if( quad ) {
+               if( lnzGridQuadTransform( quad, lt0, ln0, &lt1, &ln1, reverse ) ) {
+                   fprintf(o,"%12.8f %12.8f\n",lt1,ln1);
+                   }
+               else {
+                   fprintf(o,"Error: Point is outside the range of the grid\n");
+                   }
+               }
            else if( lnzGridTransform( grid, lt0, ln0, &lt1, &ln1, reverse ) ) {
                fprintf(o,"%12.8f %12.8f\n",lt1,ln1);
                }
@@ -150,6 +557,19 @@ int main( int argc, char *argv[] ) {
    if( d && d != stdin ) fclose(d);
    if( o && o != stdout ) fclose(o);
 
+   if( quad ) lnzGridQuadDestroy( quad );
+
+   if( pyramid ) {
+       grid = pyramid->level[0];
+       lnzGridPyramidDestroy( pyramid );
+       }
+
+   if( flat ) {
+       lnzGridDestroy( flat );
+       free( flat );
+       grid = source;
+       }
+
    lnzGridDestroy( grid );
 
    return 0;
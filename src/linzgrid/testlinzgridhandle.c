@@ -0,0 +1,213 @@
+/***********************************************************************
+*
+*  Description:
+*
+*  Test program for the grid handles of linzgridhandle.c.  This takes
+*  the name of a grid file, and makes two versions of the grid, the
+*  second with every shift increased by a constant so that the version
+*  used for a transformation can be recognised.
+*
+*  The first test acquires the first version with a reader, replaces it
+*  with the second, and checks that the first version is not released
+*  by lnzGridHandleReclaim until the reader releases it.  The program
+*  holds its own reference to the first version so that the reference
+*  held by the handle can be checked.
+*
+*  The second test runs several reader threads transforming points with
+*  the handle while the main thread repeatedly replaces the grid, and
+*  checks that every transformation matches one of the two versions
+*  exactly, and that every retired grid is reclaimed at the end.
+*
+*  The program writes the results of each check to standard output,
+*  which should match checkhandle.out.  It requires POSIX threads.
+*
+***********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "linzgrid.h"
+#include "linzgridload.h"
+#include "linzgridhandle.h"
+#include "linzgridatomic.h"
+
+#define NTEST_POINT 4
+#define NREADER 4
+#define NUPDATE 2000
+#define VERSION_OFFSET 1.0e-3
+
+static double testlat[NTEST_POINT] = { -41.2345, -45.6830, -36.8523, -43.5000 };
+static double testlon[NTEST_POINT] = { 174.7812, 169.0040, 174.7634, 172.6000 };
+
+/* The transformed test points for each version */
+
+static double explat[2][NTEST_POINT];
+static double explon[2][NTEST_POINT];
+
+static lnzGridHandle *handle;
+static volatile long stop;
+
+/* Copies the grid, adding offset to each shift */
+
+static lnzGrid *copy_grid( lnzGrid *grid, double offset ) {
+   lnzGrid *copy;
+   int nlt, i;
+
+   copy = lnzGridCreate( grid->lat0, grid->dlat, grid->nlat,
+                         grid->lon0, grid->dlon, grid->nlon );
+   if( ! lnzGridIsOk( copy ) ) {
+      if( copy ) { lnzGridDestroy( copy ); free( copy ); }
+      return NULL;
+      }
+   strcpy( copy->datum0, grid->datum0 );
+   strcpy( copy->datum1, grid->datum1 );
+   for( nlt = 0; nlt < grid->nlat; nlt++ ) {
+      for( i = 0; i < 2*grid->nlon; i++ ) {
+         copy->grid[nlt][i] = (float) (grid->grid[nlt][i] + offset);
+         }
+      }
+   return copy;
+   }
+
+/* Returns the version of the grid used to transform the test points,
+   or -1 if the results do not match either version */
+
+static int grid_version( lnzGrid *grid ) {
+   double lt[NTEST_POINT], ln[NTEST_POINT];
+   int v, i, match;
+
+   lnzGridTransformBatch( grid, NTEST_POINT, testlat, testlon, lt, ln, 0, NULL );
+   for( v = 0; v < 2; v++ ) {
+      match = 1;
+      for( i = 0; i < NTEST_POINT; i++ ) {
+         if( lt[i] != explat[v][i] || ln[i] != explon[v][i] ) match = 0;
+         }
+      if( match ) return v;
+      }
+   return -1;
+   }
+
+static void check( const char *test, int ok ) {
+   printf("  %-58s %s\n", test, ok ? "ok" : "FAILED" );
+   }
+
+/* Reader thread for the concurrent test.  Returns the number of
+   transformations that did not match either version. */
+
+static void *reader_thread( void *arg ) {
+   long *nerror = (long *) arg;
+   int reader;
+
+   *nerror = 0;
+   reader = lnzGridHandleAttach( handle );
+   if( reader < 0 ) { *nerror = 1; return NULL; }
+   /* The compare and swap reads the flag without changing it */
+   while( ! LNZ_ATOMIC_CAS( &stop, 1L, 1L ) ) {
+      lnzGrid *grid = lnzGridHandleAcquire( handle, reader );
+      if( grid_version( grid ) < 0 ) (*nerror)++;
+      lnzGridHandleRelease( handle, reader );
+      }
+   lnzGridHandleDetach( handle, reader );
+   return NULL;
+   }
+
+int main( int argc, char *argv[] ) {
+   lnzGrid *source, *version[2], *grid;
+   pthread_t thread[NREADER];
+   long nerror[NREADER];
+   int reader, reader2, nu, nt, v, nretired, ok;
+
+   if( argc != 2 ) {
+      fprintf(stderr,"Syntax: testlinzgridhandle ntv2_grid_file\n");
+      return 1;
+      }
+
+   source = lnzGridCreateFromNTv2Asc( argv[1] );
+   if( ! lnzGridIsOk( source ) ) {
+      fprintf(stderr,"Error: %s\n", lnzGridLastError(source) );
+      return 2;
+      }
+
+   for( v = 0; v < 2; v++ ) {
+      version[v] = copy_grid( source, v*VERSION_OFFSET );
+      if( ! version[v] ) {
+         fprintf(stderr,"Error: Cannot copy grid\n");
+         return 2;
+         }
+      lnzGridTransformBatch( version[v], NTEST_POINT, testlat, testlon,
+                             explat[v], explon[v], 0, NULL );
+      }
+
+   /* Replace the grid while a reader holds it */
+
+   printf("Reclaim while in use\n");
+
+   handle = lnzGridHandleCreate( version[0] );
+   check( "create handle", handle != NULL );
+   if( ! handle ) return 2;
+   lnzGridAddRef( version[0] );
+
+   reader = lnzGridHandleAttach( handle );
+   grid = lnzGridHandleAcquire( handle, reader );
+   check( "reader acquires first version", grid == version[0] );
+
+   check( "update to second version", lnzGridHandleUpdate( handle, version[1] ) );
+   nretired = lnzGridHandleReclaim( handle );
+   check( "reclaim keeps first version while reader holds it", nretired == 1 );
+   check( "handle still holds its reference to first version",
+          version[0]->refcount == 2 );
+   check( "held grid still transforms as first version",
+          grid_version( grid ) == 0 );
+
+   reader2 = lnzGridHandleAttach( handle );
+   check( "second reader acquires second version",
+          lnzGridHandleAcquire( handle, reader2 ) == version[1] );
+   lnzGridHandleRelease( handle, reader2 );
+   lnzGridHandleDetach( handle, reader2 );
+
+   lnzGridHandleRelease( handle, reader );
+   nretired = lnzGridHandleReclaim( handle );
+   check( "reclaim releases first version after reader releases it",
+          nretired == 0 && version[0]->refcount == 1 );
+   lnzGridHandleDetach( handle, reader );
+   lnzGridRelease( version[0] );
+   lnzGridHandleDestroy( handle );
+
+   /* Readers in threads while the grid is replaced repeatedly */
+
+   printf("Concurrent readers and updates\n");
+
+   grid = copy_grid( source, 0.0 );
+   handle = grid ? lnzGridHandleCreate( grid ) : NULL;
+   check( "create handle", handle != NULL );
+   if( ! handle ) return 2;
+
+   stop = 0;
+   for( nt = 0; nt < NREADER; nt++ ) {
+      pthread_create( &thread[nt], NULL, reader_thread, nerror+nt );
+      }
+
+   ok = 1;
+   for( nu = 0; nu < NUPDATE && ok; nu++ ) {
+      grid = copy_grid( source, ((nu+1) % 2)*VERSION_OFFSET );
+      ok = grid && lnzGridHandleUpdate( handle, grid );
+      }
+   check( "update grid repeatedly", ok );
+
+   LNZ_ATOMIC_INC( &stop );
+   for( nt = 0; nt < NREADER; nt++ ) pthread_join( thread[nt], NULL );
+
+   ok = 1;
+   for( nt = 0; nt < NREADER; nt++ ) if( nerror[nt] ) ok = 0;
+   check( "readers only see complete versions", ok );
+   check( "all retired versions reclaimed",
+          lnzGridHandleReclaim( handle ) == 0 );
+
+   lnzGridHandleDestroy( handle );
+   lnzGridDestroy( source );
+   free( source );
+   return 0;
+   }
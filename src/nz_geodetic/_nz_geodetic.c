@@ -1,11 +1,12 @@
 #include <Python.h>
 #include <linzgrid.h>
 #include <linzgridnzgd2k.h>
+#include <linzgridregistry.h>
 #include <nzmg.h>
 #include <nztm.h>
 
-#define NZGD49_TO_NZGD2000 0
-#define NZGD2000_TO_NZGD49 1
+#define NZGD49 "NZGD49"
+#define NZGD2000 "NZGD2000"
 
 static char module_docstring[] =
   "A module for converting between New Zealand Map Grid and NZTM2000.";
@@ -28,23 +29,38 @@ static PyMethodDef module_methods[] = {
     {NULL, NULL, 0, NULL}
 };
 
-lnzGrid linz_grid;
+lnzGridRegistry *linz_grids;
 
 PyMODINIT_FUNC init_nz_geodetic(void)
 {
+    lnzGrid *grid;
     PyObject *m = Py_InitModule3("_nz_geodetic", module_methods, module_docstring);
     if (m == NULL)
         return;
 
-    linz_grid = *lnzGridNzgd2k();
+    linz_grids = lnzGridRegistryCreate();
+    grid = lnzGridCreateNzgd2k();
 
-    if (!lnzGridIsOk(&linz_grid)) {
-        PyErr_SetString(PyExc_RuntimeError, lnzGridLastError(&linz_grid));
-        lnzGridDestroy(&linz_grid);
+    if (!linz_grids || !lnzGridRegistryAdd(linz_grids, grid)) {
+        PyErr_SetString(PyExc_RuntimeError, lnzGridLastError(grid));
+        lnzGridDestroy(grid);
+        free(grid);
         return;
     }
 }
 
+static int linz_transform(const char *datum0, const char *datum1,
+                          double lts, double lns, double *ltd, double *lnd)
+{
+    int reverse, ok;
+    lnzGrid *grid = lnzGridRegistryFind(linz_grids, datum0, datum1, &reverse);
+    if (!grid)
+        return 0;
+    ok = lnzGridTransform(grid, lts, lns, ltd, lnd, reverse);
+    lnzGridRelease(grid);
+    return ok;
+}
+
 static PyObject *linz_nzmg_to_nztm(PyObject *self, PyObject *args)
 {
     double n, e, lt49, ln49, lt2000, ln2000, n2000, e2000;
@@ -54,7 +70,7 @@ static PyObject *linz_nzmg_to_nztm(PyObject *self, PyObject *args)
         return NULL;
 
     nzmg_geod(n, e, &lt49, &ln49);
-    lnzGridTransform(&linz_grid, lt49, ln49, &lt2000, &ln2000, NZGD49_TO_NZGD2000); //TODO: test return code
+    linz_transform(NZGD49, NZGD2000, lt49, ln49, &lt2000, &ln2000); //TODO: test return code
     geod_nztm(lt2000, ln2000, &n2000, &e2000);
 
     {
@@ -72,7 +88,7 @@ static PyObject *linz_nztm_to_nzmg(PyObject *self, PyObject *args)
         return NULL;
 
     nzmg_geod(n2000, e2000, &lt2000, &ln2000);
-    lnzGridTransform(&linz_grid, lt2000, ln2000, &lt49, &ln49, NZGD2000_TO_NZGD49); //TODO: test return code
+    linz_transform(NZGD2000, NZGD49, lt2000, ln2000, &lt49, &ln49); //TODO: test return code
     geod_nztm(lt49, ln49, &n49, &e49);
 
     {
@@ -1,5 +1,8 @@
 #include "nzmg.h"
 
+#include <math.h>
+#include <float.h>
+
 /* Defines PI (from Abramowitz and Stegun Table 1.1) */
 
 #define PI 3.1415926535898
@@ -106,9 +109,12 @@ static complex *cscale(complex *cr, complex *c1, double sc) {
 /*                                                                */
 /*----------------------------------------------------------------*/
 
-void nzmg_geod( double n, double e, double *lt, double *ln ) {
+/* Calculates zeta, the differences of isometric latitude and of 
+   longitude from the origin (radians, as the real and imaginary parts),
+   from the NZMG northing and easting */
+
+static void nzmg_zeta( double n, double e, complex *zeta ) {
   complex z0, z1, zn, zd, tmp1, tmp2;
-  double sum,tmp;
   short i, it;
 
   z0.real = (n-n0)/a;     z0.imag = (e-e0)/a;
@@ -128,6 +134,16 @@ void nzmg_geod( double n, double e, double *lt, double *ln ) {
      cdiv( &z1, &zn, &zd );
      }
 
+  *zeta = z1;
+  }
+
+void nzmg_geod( double n, double e, double *lt, double *ln ) {
+  complex z1;
+  double sum,tmp;
+  short i;
+
+   nzmg_zeta( n, e, &z1 );
+
    *ln = ln0/rad2deg + z1.imag;
 
    tmp = z1.real;
@@ -157,6 +173,374 @@ void geod_nzmg( double lt, double ln, double *n, double *e ) {
   *e = e0+z0.imag*a;
   }
 
+/*----------------------------------------------------------------*/
+/*                                                                */
+/*  Conversion of arrays of latitude and longitude to fixed       */
+/*  point (integer) NZMG coordinates, for example integer         */
+/*  millimetres.  The outputs are (n-norg)*scale and              */
+/*  (e-eorg)*scale rounded to the nearest integer (ties to even). */
+/*  geod_nzmg_fixed32 is for offsets from a local origin that     */
+/*  fit in an int.  Points are converted in chunks of             */
+/*  NZMG_FIXED_CHUNK, and each chunk is rounded in a loop that    */
+/*  compilers can vectorise, so there is no second pass over the  */
+/*  data.  The outputs are not defined for points out of range.   */
+/*                                                                */
+/*----------------------------------------------------------------*/
+
+#define NZMG_FIXED_CHUNK 256
+
+/* Rounds to the nearest integer (ties to even) without branches or 
+   library calls, by adding and subtracting 1.5*2^52 (which leaves no 
+   bits for the fraction).  This relies on doubles being evaluated in 
+   double precision, so floor is used if the compiler uses extra 
+   precision, rounding halves down to the even integer if 
+   floor(x + 0.5) is odd.  Valid for magnitudes less than 2^51. */
+
+#define ROUND_MAGIC 6755399441055744.0
+
+static double round_nearest( double x ) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  return (x + ROUND_MAGIC) - ROUND_MAGIC;
+#else
+  double r = floor(x + 0.5);
+  if( r - x == 0.5 && fmod(r, 2.0) != 0.0 ) r -= 1.0;
+  return r;
+#endif
+  }
+
+void geod_nzmg_fixed( int npt, const double *lt, const double *ln,
+                      double norg, double eorg, double scale,
+                      long long *n, long long *e ) {
+  double bn[NZMG_FIXED_CHUNK], be[NZMG_FIXED_CHUNK];
+  int i, j, nb;
+
+  for( i = 0; i < npt; i += NZMG_FIXED_CHUNK ) {
+     nb = npt - i < NZMG_FIXED_CHUNK ? npt - i : NZMG_FIXED_CHUNK;
+     for( j = 0; j < nb; j++ ) geod_nzmg( lt[i+j], ln[i+j], bn+j, be+j );
+     for( j = 0; j < nb; j++ ) {
+        n[i+j] = (long long) round_nearest( (bn[j]-norg)*scale );
+        e[i+j] = (long long) round_nearest( (be[j]-eorg)*scale );
+        }
+     }
+  }
+
+void geod_nzmg_fixed32( int npt, const double *lt, const double *ln,
+                        double norg, double eorg, double scale,
+                        int *n, int *e ) {
+  double bn[NZMG_FIXED_CHUNK], be[NZMG_FIXED_CHUNK];
+  int i, j, nb;
+
+  for( i = 0; i < npt; i += NZMG_FIXED_CHUNK ) {
+     nb = npt - i < NZMG_FIXED_CHUNK ? npt - i : NZMG_FIXED_CHUNK;
+     for( j = 0; j < nb; j++ ) geod_nzmg( lt[i+j], ln[i+j], bn+j, be+j );
+     for( j = 0; j < nb; j++ ) {
+        n[i+j] = (int) round_nearest( (bn[j]-norg)*scale );
+        e[i+j] = (int) round_nearest( (be[j]-eorg)*scale );
+        }
+     }
+  }
+
+void geod_nzmg_mm( int npt, const double *lt, const double *ln,
+                   long long *n, long long *e ) {
+  geod_nzmg_fixed( npt, lt, ln, 0.0, 0.0, 1000.0, n, e );
+  }
+
+/*----------------------------------------------------------------*/
+/*                                                                */
+/*  Single precision conversions in a local frame.  A float       */
+/*  cannot hold NZMG coordinates to better than about half a      */
+/*  metre, but can hold offsets from a local origin to about      */
+/*  1e-7 of the offset.  define_nzmg_frame reexpands each of the  */
+/*  NZMG series as a series in the offsets from the origin of     */
+/*  the frame, so the frame routines evaluate the same series as  */
+/*  nzmg_geod and geod_nzmg, in float arithmetic.  They are       */
+/*  evaluated for blocks of NZMG_FRAME_BLOCK points in loops over */
+/*  the block, which compilers can vectorise with twice as many   */
+/*  floats as doubles in each vector register.                    */
+/*                                                                */
+/*----------------------------------------------------------------*/
+
+#define NZMG_FRAME_BLOCK 16
+
+/* Reexpands the polynomial with coefficients c[0..nc] as a polynomial
+   in x-x0, or z-z0 */
+
+static void poly_shift( double *c, int nc, double x0 ) {
+   int i, k;
+   for( i = 0; i < nc; i++ ) {
+      for( k = nc-1; k >= i; k-- ) c[k] += x0*c[k+1];
+      }
+   }
+
+static void cpoly_shift( complex *c, int nc, complex *z0 ) {
+   complex tmp;
+   int i, k;
+   for( i = 0; i < nc; i++ ) {
+      for( k = nc-1; k >= i; k-- ) cadd( c+k, c+k, cmult( &tmp, z0, c+k+1 ) );
+      }
+   }
+
+void define_nzmg_frame( nzmgframe *fr, double n, double e ) {
+   double c[11];
+   complex cc[7], z0, zeta;
+   double s, scl, jac[2][2];
+   short i, j;
+   int ex;
+
+   fr->n = n;
+   fr->e = e;
+   nzmg_geod( n, e, &fr->lt, &fr->ln );
+   nzmg_zeta( n, e, &zeta );
+
+   /* Isometric latitude in terms of the latitude offset */
+
+   c[0] = 0.0;
+   for( i = 0; i < 10; i++ ) c[i+1] = cfi[i];
+   poly_shift( c, 10, (fr->lt*rad2deg - lt0) * 3600.0e-5 );
+   c[0] -= zeta.real;
+   s = 1.0;
+   for( i = 0; i <= 10; i++ ) {
+      c[i] *= s;
+      fr->psi[i] = (float) c[i];
+      s *= rad2deg * 3600.0e-5;
+      }
+
+   /* Grid coordinates in terms of the offset of zeta.  The linear 
+      terms of the grid coordinates in terms of the latitude and 
+      longitude offsets are split into a leading float and the 
+      remainder, which are evaluated separately */
+
+   cc[0].real = cc[0].imag = 0.0;
+   for( i = 0; i < 6; i++ ) cc[i+1] = cfb1[i];
+   cpoly_shift( cc, 6, &zeta );
+   cc[0].real -= (n-n0)/a;
+   cc[0].imag -= (e-e0)/a;
+   for( i = 0; i <= 6; i++ ) {
+      fr->grid[i][0] = (float) (cc[i].real*a);
+      fr->grid[i][1] = (float) (cc[i].imag*a);
+      }
+   fr->grid1[0] = fr->grid[1][0];
+   fr->grid1[1] = fr->grid[1][1];
+   fr->grid[1][0] = (float) (cc[1].real*a - fr->grid1[0]);
+   fr->grid[1][1] = (float) (cc[1].imag*a - fr->grid1[1]);
+
+   jac[0][0] = cc[1].real*a*c[1];
+   jac[0][1] = -cc[1].imag*a;
+   jac[1][0] = cc[1].imag*a*c[1];
+   jac[1][1] = cc[1].real*a;
+   for( i = 0; i < 2; i++ ) for( j = 0; j < 2; j++ ) {
+      fr->fwdlin[i][j] = (float) jac[i][j];
+      fr->fwdlo[i][j] = (float) (jac[i][j] - fr->fwdlin[i][j]);
+      }
+
+   /* Initial estimate of zeta in terms of the grid offset, scaled by 
+      a power of 2 close to 1/a so that the coefficients do not 
+      underflow */
+
+   frexp( a, &ex );
+   scl = ldexp( 1.0, 1-ex );
+   fr->zscale = (float) scl;
+   z0.real = (n-n0)/a;
+   z0.imag = (e-e0)/a;
+   cc[0].real = cc[0].imag = 0.0;
+   for( i = 0; i < 6; i++ ) cc[i+1] = cfb2[i];
+   cpoly_shift( cc, 6, &z0 );
+   csub( cc, cc, &zeta );
+   s = 1.0;
+   for( i = 0; i <= 6; i++ ) {
+      fr->zeta[i][0] = (float) (cc[i].real*s);
+      fr->zeta[i][1] = (float) (cc[i].imag*s);
+      s /= a*scl;
+      }
+
+   /* Latitude in terms of the isometric latitude offset */
+
+   c[0] = 0.0;
+   for( i = 0; i < 9; i++ ) c[i+1] = cfl[i]/(3600.0e-5*rad2deg);
+   poly_shift( c, 9, zeta.real );
+   c[0] += lt0/rad2deg - fr->lt;
+   for( i = 0; i <= 9; i++ ) fr->lat[i] = (float) c[i];
+   fr->lat1 = fr->lat[1];
+   fr->lat[1] = (float) (c[1] - fr->lat1);
+   }
+
+/* nzmg_geod_frame starts from the reexpanded inverse series and uses
+   the same two Newton-Raphson iterations as nzmg_geod.  The residual 
+   is evaluated with the leading part of the linear term first, as it
+   nearly cancels the grid offset */
+
+void nzmg_geod_frame( const nzmgframe *fr, int npt,
+                      const float *dn, const float *de,
+                      float *dlt, float *dln ) {
+   float xr[NZMG_FRAME_BLOCK], xi[NZMG_FRAME_BLOCK];
+   float sr[NZMG_FRAME_BLOCK], si[NZMG_FRAME_BLOCK];
+   float wr[NZMG_FRAME_BLOCK], wi[NZMG_FRAME_BLOCK];
+   float gr[NZMG_FRAME_BLOCK], gi[NZMG_FRAME_BLOCK];
+   float dr[NZMG_FRAME_BLOCK], di[NZMG_FRAME_BLOCK];
+   float t, dd, zs = fr->zscale;
+   int ip, j, nb, it;
+   short i;
+
+   for( ip = 0; ip < npt; ip += NZMG_FRAME_BLOCK ) {
+      nb = npt - ip < NZMG_FRAME_BLOCK ? npt - ip : NZMG_FRAME_BLOCK;
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         xr[j] = j < nb ? dn[ip+j] : 0.0f;
+         xi[j] = j < nb ? de[ip+j] : 0.0f;
+         sr[j] = xr[j]*zs;
+         si[j] = xi[j]*zs;
+         }
+
+      /* Initial estimate of zeta */
+
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         wr[j] = fr->zeta[6][0];
+         wi[j] = fr->zeta[6][1];
+         }
+      for( i = 6; i--; ) {
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+            t     = wr[j]*sr[j] - wi[j]*si[j] + fr->zeta[i][0];
+            wi[j] = wr[j]*si[j] + wi[j]*sr[j] + fr->zeta[i][1];
+            wr[j] = t;
+            }
+         }
+
+      for( it = 2; it--; ) {
+
+         /* Terms of degree 2 and higher of the grid coordinates, g, and
+            the derivative, d */
+
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+            gr[j] = fr->grid[6][0];
+            gi[j] = fr->grid[6][1];
+            dr[j] = 6.0f*fr->grid[6][0];
+            di[j] = 6.0f*fr->grid[6][1];
+            }
+         for( i = 5; i >= 2; i-- ) {
+            for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+               t     = gr[j]*wr[j] - gi[j]*wi[j] + fr->grid[i][0];
+               gi[j] = gr[j]*wi[j] + gi[j]*wr[j] + fr->grid[i][1];
+               gr[j] = t;
+               t     = dr[j]*wr[j] - di[j]*wi[j] + i*fr->grid[i][0];
+               di[j] = dr[j]*wi[j] + di[j]*wr[j] + i*fr->grid[i][1];
+               dr[j] = t;
+               }
+            }
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+            t     = gr[j]*wr[j] - gi[j]*wi[j];
+            gi[j] = gr[j]*wi[j] + gi[j]*wr[j];
+            gr[j] = t;
+            t     = dr[j]*wr[j] - di[j]*wi[j] + fr->grid1[0];
+            di[j] = dr[j]*wi[j] + di[j]*wr[j] + fr->grid1[1];
+            dr[j] = t;
+            }
+
+         /* Residual and Newton-Raphson step */
+
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+            t     = (fr->grid1[0]*wr[j] - xr[j]) - fr->grid1[1]*wi[j]
+                    + ((gr[j]*wr[j] - gi[j]*wi[j]) + fr->grid[1][0]*wr[j]
+                       - fr->grid[1][1]*wi[j] + fr->grid[0][0]);
+            gi[j] = (fr->grid1[0]*wi[j] - xi[j]) + fr->grid1[1]*wr[j]
+                    + ((gr[j]*wi[j] + gi[j]*wr[j]) + fr->grid[1][0]*wi[j]
+                       + fr->grid[1][1]*wr[j] + fr->grid[0][1]);
+            gr[j] = t;
+            dd = dr[j]*dr[j] + di[j]*di[j];
+            wr[j] -= (gr[j]*dr[j] + gi[j]*di[j])/dd;
+            wi[j] -= (gi[j]*dr[j] - gr[j]*di[j])/dd;
+            }
+         }
+
+      /* Latitude from the isometric latitude */
+
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) xr[j] = fr->lat[9];
+      for( i = 8; i >= 2; i-- ) {
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) xr[j] = xr[j]*wr[j] + fr->lat[i];
+         }
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         xr[j] = fr->lat1*wr[j] 
+                 + ((xr[j]*wr[j] + fr->lat[1])*wr[j] + fr->lat[0]);
+         }
+
+      for( j = 0; j < nb; j++ ) {
+         dlt[ip+j] = xr[j];
+         dln[ip+j] = wi[j];
+         }
+      }
+   }
+
+/* geod_nzmg_frame calculates the terms of the grid coordinates of 
+   degree 2 and higher in the latitude and longitude offsets, and then 
+   adds the linear terms */
+
+void geod_nzmg_frame( const nzmgframe *fr, int npt,
+                      const float *dlt, const float *dln,
+                      float *dn, float *de ) {
+   float x[NZMG_FRAME_BLOCK], l[NZMG_FRAME_BLOCK];
+   float p[NZMG_FRAME_BLOCK], q[NZMG_FRAME_BLOCK];
+   float zr[NZMG_FRAME_BLOCK], zi[NZMG_FRAME_BLOCK];
+   float t, sr, si;
+   int ip, j, nb;
+   short i;
+
+   for( ip = 0; ip < npt; ip += NZMG_FRAME_BLOCK ) {
+      nb = npt - ip < NZMG_FRAME_BLOCK ? npt - ip : NZMG_FRAME_BLOCK;
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         x[j] = j < nb ? dlt[ip+j] : 0.0f;
+         l[j] = j < nb ? dln[ip+j] : 0.0f;
+         }
+
+      /* Isometric latitude offset p, and its nonlinear part q */
+
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) q[j] = fr->psi[10];
+      for( i = 9; i >= 2; i-- ) {
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) q[j] = q[j]*x[j] + fr->psi[i];
+         }
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         q[j] = q[j]*x[j]*x[j] + fr->psi[0];
+         p[j] = fr->psi[1]*x[j] + q[j];
+         }
+
+      /* Terms of degree 2 and higher in p + i l */
+
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         zr[j] = fr->grid[6][0];
+         zi[j] = fr->grid[6][1];
+         }
+      for( i = 5; i >= 2; i-- ) {
+         for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+            t     = zr[j]*p[j] - zi[j]*l[j] + fr->grid[i][0];
+            zi[j] = zr[j]*l[j] + zi[j]*p[j] + fr->grid[i][1];
+            zr[j] = t;
+            }
+         }
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         sr = p[j]*p[j] - l[j]*l[j];
+         si = 2.0f*p[j]*l[j];
+         t     = zr[j]*sr - zi[j]*si;
+         zi[j] = zr[j]*si + zi[j]*sr;
+         zr[j] = t;
+         }
+
+      /* Add the linear terms */
+
+      for( j = 0; j < NZMG_FRAME_BLOCK; j++ ) {
+         zr[j] += fr->grid1[0]*q[j] + fr->grid[1][0]*p[j] 
+                  - fr->grid[1][1]*l[j] + fr->grid[0][0];
+         zi[j] += fr->grid1[1]*q[j] + fr->grid[1][1]*p[j] 
+                  + fr->grid[1][0]*l[j] + fr->grid[0][1];
+         zr[j] = fr->fwdlin[0][0]*x[j] + (fr->fwdlin[0][1]*l[j] 
+                 + (zr[j] + fr->fwdlo[0][0]*x[j] + fr->fwdlo[0][1]*l[j]));
+         zi[j] = fr->fwdlin[1][0]*x[j] + (fr->fwdlin[1][1]*l[j] 
+                 + (zi[j] + fr->fwdlo[1][0]*x[j] + fr->fwdlo[1][1]*l[j]));
+         }
+
+      for( j = 0; j < nb; j++ ) {
+         dn[ip+j] = zr[j];
+         de[ip+j] = zi[j];
+         }
+      }
+   }
+
 #ifdef TEST_NZMG
 
 #include <stdio.h>
@@ -177,3 +561,125 @@ int main( int argc, char *argv[] ) {
   }
 
 #endif
+
+#ifdef BENCH_NZMG
+
+/* Compares the single precision local frame routines with nzmg_geod 
+   and geod_nzmg, for frames centred in NZ of several sizes, and times 
+   them */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_NPT 100000
+#define BENCH_REPEAT 20
+
+static double bench_seconds( clock_t start ) {
+   return (double)(clock()-start)/CLOCKS_PER_SEC;
+   }
+
+int main( int argc, char *argv[] ) {
+   static const double frange[] = { 10.0e3, 50.0e3, 100.0e3, 400.0e3 };
+   float *fn, *fe, *flt, *fln, *fn1, *fe1;
+   double *lt, *ln, *n1, *e1, tgeod, tnzmg, diff, maxlt, maxn, en, ee;
+   nzmgframe fr;
+   clock_t start;
+   int npt = BENCH_NPT;
+   int i, r, ir;
+
+   fn = (float *) malloc( 6 * npt * sizeof(float) );
+   lt = (double *) malloc( 4 * npt * sizeof(double) );
+   if( ! fn || ! lt ) return 1;
+   fe = fn + npt; flt = fe + npt; fln = flt + npt; 
+   fn1 = fln + npt; fe1 = fn1 + npt;
+   ln = lt + npt; n1 = ln + npt; e1 = n1 + npt;
+
+   for( ir = 0; ir < (int) (sizeof(frange)/sizeof(frange[0])); ir++ ) {
+      double range = frange[ir];
+      define_nzmg_frame( &fr, 6000000.0, 2600000.0 );
+      for( i = 0; i < npt; i++ ) {
+         fn[i] = (float) (range*(2.0*rand()/RAND_MAX-1.0));
+         fe[i] = (float) (range*(2.0*rand()/RAND_MAX-1.0));
+         }
+
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         nzmg_geod_frame( &fr, npt, fn, fe, flt, fln );
+         }
+      tnzmg = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_nzmg_frame( &fr, npt, flt, fln, fn1, fe1 );
+         }
+      tgeod = bench_seconds( start );
+
+      maxlt = maxn = 0.0;
+      for( i = 0; i < npt; i++ ) {
+         nzmg_geod( fr.n+fn[i], fr.e+fe[i], lt+i, ln+i );
+         diff = hypot( fr.lt+flt[i]-lt[i], (fr.ln+fln[i]-ln[i])*cos(lt[i]) )*a;
+         if( diff > maxlt ) maxlt = diff;
+         geod_nzmg( fr.lt+flt[i], fr.ln+fln[i], &en, &ee );
+         diff = hypot( fr.n+fn1[i]-en, fr.e+fe1[i]-ee );
+         if( diff > maxn ) maxn = diff;
+         }
+      printf("frame %3.0lfkm nzmg_geod %6.1lf ns/point  geod_nzmg %6.1lf ns/point"
+             "  max diff %.2le %.2le m\n",
+          range/1000.0, tnzmg*1.0e9/(npt*BENCH_REPEAT),
+          tgeod*1.0e9/(npt*BENCH_REPEAT), maxlt, maxn );
+      }
+
+   start = clock();
+   for( r = 0; r < BENCH_REPEAT; r++ ) {
+      for( i = 0; i < npt; i++ ) nzmg_geod( fr.n+fn[i], fr.e+fe[i], lt+i, ln+i );
+      }
+   tnzmg = bench_seconds( start );
+   start = clock();
+   for( r = 0; r < BENCH_REPEAT; r++ ) {
+      for( i = 0; i < npt; i++ ) geod_nzmg( lt[i], ln[i], n1+i, e1+i );
+      }
+   tgeod = bench_seconds( start );
+   printf("double    nzmg_geod %6.1lf ns/point  geod_nzmg %6.1lf ns/point\n",
+       tnzmg*1.0e9/(npt*BENCH_REPEAT), tgeod*1.0e9/(npt*BENCH_REPEAT) );
+
+   /* Integer millimetre output, compared with rounding the doubles in
+      a second pass */
+
+   {
+      long long *in, *ie, *in1, *ie1;
+      int nbad = 0;
+
+      in = (long long *) malloc( 4 * npt * sizeof(long long) );
+      if( ! in ) return 1;
+      ie = in + npt; in1 = ie + npt; ie1 = in1 + npt;
+
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         for( i = 0; i < npt; i++ ) geod_nzmg( lt[i], ln[i], n1+i, e1+i );
+         for( i = 0; i < npt; i++ ) {
+            in1[i] = llrint( n1[i]*1000.0 );
+            ie1[i] = llrint( e1[i]*1000.0 );
+            }
+         }
+      tgeod = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_nzmg_mm( npt, lt, ln, in, ie );
+         }
+      tnzmg = bench_seconds( start );
+      for( i = 0; i < npt; i++ ) {
+         if( in[i] != in1[i] || ie[i] != ie1[i] ) nbad++;
+         }
+      printf("mm        geod_nzmg %6.1lf ns/point  geod_nzmg_mm %6.1lf ns/point"
+             "  differences %d\n",
+          tgeod*1.0e9/(npt*BENCH_REPEAT), tnzmg*1.0e9/(npt*BENCH_REPEAT), 
+          nbad );
+      free( in );
+   }
+
+   free( fn );
+   free( lt );
+   return 0;
+   }
+
+#endif
@@ -15,5 +15,50 @@
 void nzmg_geod( double n, double e, double *lt, double *ln );
 void geod_nzmg( double lt, double ln, double *n, double *e );
 
+/* Convert arrays of latitude and longitude to fixed point NZMG 
+   coordinates: (n-norg)*scale and (e-eorg)*scale rounded to the 
+   nearest integer.  geod_nzmg_mm gives integer millimetres, and the
+   _fixed32 version is for offsets from a local origin that fit in an
+   int. */
+
+void geod_nzmg_fixed( int npt, const double *lt, const double *ln,
+                      double norg, double eorg, double scale,
+                      long long *n, long long *e );
+void geod_nzmg_fixed32( int npt, const double *lt, const double *ln,
+                        double norg, double eorg, double scale,
+                        int *n, int *e );
+void geod_nzmg_mm( int npt, const double *lt, const double *ln,
+                   long long *n, long long *e );
+
+/* Local frame for single precision (float) conversions, for example
+   for drawing maps.  Coordinates are offsets from the frame origin:
+   northing and easting offsets in metres, and latitude and longitude
+   offsets in radians.  define_nzmg_frame reexpands the NZMG series 
+   about the origin n, e, and the frame routines evaluate them in float
+   arithmetic, so are accurate to about 1e-7 of the offset from the 
+   origin. */
+
+typedef struct {
+   double n, e;             /* Northing and easting of the origin */
+   double lt, ln;           /* Latitude and longitude of the origin */
+   float psi[11];           /* Isometric latitude series */
+   float grid[7][2];        /* Grid coordinate series */
+   float zeta[7][2];        /* Inverse grid coordinate series */
+   float zscale;            /* Scale of the grid offsets in zeta */
+   float lat[10];           /* Latitude series */
+   float fwdlin[2][2];      /* Linear terms of the grid coordinates */
+   float fwdlo[2][2];
+   float grid1[2];          /* Leading parts of grid[1] and lat[1] */
+   float lat1;
+   } nzmgframe;
+
+void define_nzmg_frame( nzmgframe *fr, double n, double e );
+void nzmg_geod_frame( const nzmgframe *fr, int npt,
+                      const float *dn, const float *de,
+                      float *dlt, float *dln );
+void geod_nzmg_frame( const nzmgframe *fr, int npt,
+                      const float *dlt, const float *dln,
+                      float *dn, float *de );
+
 
 #endif
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "nztm.h"
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <float.h>
 
 /* Defines PI (from Abramowitz and Stegun Table 1.1) */
 
@@ -8,29 +12,101 @@
 #define TWOPI (2.0*PI)
 #define rad2deg (180/PI)
 
-/* Structure used to define a TM projection */
+/* Wraps a longitude relative to the central meridian into the range 
+   -PI to PI, without branches, so that it can be used efficiently (and 
+   vectorised) in the batch routines.  dlon/TWOPI is rounded to the 
+   nearest integer by adding and subtracting 1.5*2^52, which leaves no 
+   bits for the fraction.  This relies on doubles being evaluated in 
+   double precision, so floor is used if the compiler uses extra 
+   precision (eg the x87 floating point unit).  Longitudes within 
+   3*PI of the central meridian are wrapped exactly as by adding or 
+   subtracting TWOPI once. */
 
-typedef struct {
-	    double meridian;          /* Central meridian */
-	    double scalef;            /* Scale factor */
-	    double orglat;            /* Origin latitude */
-	    double falsee;            /* False easting */
-	    double falsen;            /* False northing */
-	    double utom;              /* Unit to metre conversion */
+#define ROUND_MAGIC 6755399441055744.0
+
+static double wrap_dlon( double dlon ) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    double k = (dlon/TWOPI + ROUND_MAGIC) - ROUND_MAGIC;
+#else
+    double k = floor(dlon/TWOPI + 0.5);
+#endif
+    return dlon - k*TWOPI;
+    }
+
+/* Rounds to the nearest integer (ties to even) without branches or 
+   library calls, so that loops using it can be vectorised, by the same
+   method as wrap_dlon.  The floor fallback rounds halves down to the 
+   even integer if floor(x + 0.5) is odd, so that the result is the 
+   same.  Valid for magnitudes less than 2^51. */
+
+static double round_nearest( double x ) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    return (x + ROUND_MAGIC) - ROUND_MAGIC;
+#else
+    double r = floor(x + 0.5);
+    if( r - x == 0.5 && fmod(r, 2.0) != 0.0 ) r -= 1.0;
+    return r;
+#endif
+    }
 
-	    double a, rf, f, e2, ep2;     /* Ellipsoid parameters */
-	    double om;                /* Intermediate calculation */
-	    } tmprojection;
+/* The Redfearn series are evaluated by functions which are always 
+   inlined (with compilers that support it), so that when they are 
+   called for one of the built in projections (see tm_geod_special) the
+   projection parameters and coefficients are constants which the 
+   compiler can fold into the code. */
 
+#if defined(__GNUC__)
+#define TM_INLINE static __inline__ __attribute__((always_inline))
+#else
+#define TM_INLINE static
+#endif
+
+static double meridian_arc( const tmprojection *tm, double lt );
+static void kruger_sum( const double *c, double xi, double eta,
+   double *sxi, double *seta, double *dxi, double *deta );
+static double conformal_tau( double e, double tau );
+static void scale_conv_calc( const tmprojection *tm, double slt, double clt,
+   double dlon, double *k, double *conv );
+static int approx_calc( const tmapprox *ap, int inverse, 
+   double x, double y, double *o1, double *o2 );
+static int tm_geod_special( const tmprojection *tm, int npt,
+   const double *ce, const double *cn, int instride,
+   double *ln, double *lt, int outstride );
+static int geod_tm_special( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, int instride,
+   double *ce, double *cn, int outstride );
+
+#ifdef NZTM_SIMD
+
+/* Vector implementations of the batch routines, in nztmsimd.c */
 
-static double meridian_arc( tmprojection *tm, double lt );
+int tm_geod_simd( const tmprojection *tm, int npt,
+   const double *ce, const double *cn, double *ln, double *lt );
+int geod_tm_simd( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, double *ce, double *cn );
+int tm_simd_sincos( int npt, const double *x, double *s, double *c );
 
-/* Initiallize the TM structure  */
+#endif
+
+/* Initiallize the TM structure, including the coefficients of the 
+   meridian arc and foot point latitude series  */
 
-static void define_tmprojection( tmprojection *tm, double a, double rf,
+void define_tmprojection( tmprojection *tm, double a, double rf,
    double cm, double sf, double lto, double fe, double fn, double utom ) {
 
    double f;
+   double e2;
+   double e4;
+   double e6;
+   double n;
+   double n2;
+   double n3;
+   double n4;
+   double n5;
+   double n6;
+   double xi;
+   double sxi;
+   double seta;
 
    tm->meridian = cm;
    tm->scalef = sf;
@@ -45,7 +121,77 @@ static void define_tmprojection( tmprojection *tm, double a, double rf,
    tm->e2 = 2.0*f - f*f;
    tm->ep2 = tm->e2/( 1.0 - tm->e2 );
 
+   e2 = tm->e2;
+   e4 = e2*e2;
+   e6 = e4*e2;
+   tm->e4 = e4;
+   tm->e6 = e6;
+   tm->A0 = 1 - (e2/4.0) - (3.0*e4/64.0) - (5.0*e6/256.0);
+   tm->A2 = (3.0/8.0) * (e2+e4/4.0+15.0*e6/128.0);
+   tm->A4 = (15.0/256.0) * (e4 + 3.0*e6/4.0);
+   tm->A6 = 35.0*e6/3072.0;
+
+   n  = f/(2.0-f);
+   n2 = n*n;
+   n3 = n2*n;
+   n4 = n2*n2;
+   tm->n = n;
+   tm->n2 = n2;
+   tm->n3 = n3;
+   tm->n4 = n4;
+   tm->g = a*(1.0-n)*(1.0-n2)*(1+9.0*n2/4.0+225.0*n4/64.0);
+   tm->fp2 = 3.0*n/2.0 - 27.0*n3/32.0;
+   tm->fp4 = 21.0*n2/16.0 - 55.0*n4/32.0;
+   tm->fp6 = 151.0*n3/96.0;
+   tm->fp8 = 1097.0*n4/512.0;
+
    tm->om = meridian_arc( tm, tm->orglat );
+
+   /* Coefficients of the Kruger series (Karney, 2011, equations 35 
+      and 36), the rectifying radius, and the rectifying latitude of 
+      the origin */
+
+   n5 = n4*n;
+   n6 = n3*n3;
+   tm->method = TM_REDFEARN;
+   tm->e = sqrt(tm->e2);
+   tm->A = a/(1.0+n)*(1.0 + n2/4.0 + n4/64.0 + n6/256.0);
+
+   tm->alpha[0] = n/2.0 - 2.0*n2/3.0 + 5.0*n3/16.0 + 41.0*n4/180.0
+                  - 127.0*n5/288.0 + 7891.0*n6/37800.0;
+   tm->alpha[1] = 13.0*n2/48.0 - 3.0*n3/5.0 + 557.0*n4/1440.0
+                  + 281.0*n5/630.0 - 1983433.0*n6/1935360.0;
+   tm->alpha[2] = 61.0*n3/240.0 - 103.0*n4/140.0 + 15061.0*n5/26880.0
+                  + 167603.0*n6/181440.0;
+   tm->alpha[3] = 49561.0*n4/161280.0 - 179.0*n5/168.0 
+                  + 6601661.0*n6/7257600.0;
+   tm->alpha[4] = 34729.0*n5/80640.0 - 3418889.0*n6/1995840.0;
+   tm->alpha[5] = 212378941.0*n6/319334400.0;
+
+   tm->beta[0] = n/2.0 - 2.0*n2/3.0 + 37.0*n3/96.0 - n4/360.0
+                 - 81.0*n5/512.0 + 96199.0*n6/604800.0;
+   tm->beta[1] = n2/48.0 + n3/15.0 - 437.0*n4/1440.0 + 46.0*n5/105.0
+                 - 1118711.0*n6/3870720.0;
+   tm->beta[2] = 17.0*n3/480.0 - 37.0*n4/840.0 - 209.0*n5/4480.0
+                 + 5569.0*n6/90720.0;
+   tm->beta[3] = 4397.0*n4/161280.0 - 11.0*n5/504.0 
+                 - 830251.0*n6/7257600.0;
+   tm->beta[4] = 4583.0*n5/161280.0 - 108847.0*n6/3991680.0;
+   tm->beta[5] = 20648693.0*n6/638668800.0;
+
+   xi = atan( conformal_tau( tm->e, tan(lto) ) );
+   kruger_sum( tm->alpha, xi, 0.0, &sxi, &seta, 0, 0 );
+   tm->xi0 = xi + sxi;
+
+   tm->approx = 0;
+   }
+
+/* Selects the method used to evaluate the projection */
+
+int set_tmprojection_method( tmprojection *tm, int method ) {
+   if( method != TM_REDFEARN && method != TM_KRUGER ) return 0;
+   tm->method = method;
+   return 1;
    }
 
 
@@ -53,38 +199,43 @@ static void define_tmprojection( tmprojection *tm, double a, double rf,
 /*                                                                         */
 /*  meridian_arc                                                           */
 /*                                                                         */
-/*  Returns the length of meridional arc (Helmert formula)                 */
+/*  Returns the length of meridional arc (Helmert formula), using the      */
+/*  coefficients calculated by define_tmprojection                         */
 /*  Method based on Redfearn's formulation as expressed in GDA technical   */
 /*  manual at http://www.anzlic.org.au/icsm/gdatm/index.html               */
 /*                                                                         */
+/*  The multiple angle terms sin(2*lt), sin(4*lt), and sin(6*lt) are       */
+/*  summed with Clenshaw's recurrence from the sin and cos of the          */
+/*  latitude, which the caller also needs for the rest of the series, so   */
+/*  no further trigonometric functions are evaluated.                      */
+/*                                                                         */
 /*  Parameters are                                                         */
 /*    projection                                                           */
-/*    latitude (radians)                                                   */
+/*    latitude (radians), and its sin and cos                              */
 /*                                                                         */
 /*  Return value is the arc length in metres                               */
 /*                                                                         */
 /***************************************************************************/
 
 
-static double meridian_arc( tmprojection *tm, double lt ) {
-    double e2 = tm->e2;
-    double a = tm->a;
-    double e4;
-    double e6;
-    double A0;
-    double A2;
-    double A4;
-    double A6;
-
-    e4 = e2*e2;
-    e6 = e4*e2;
- 
-    A0 = 1 - (e2/4.0) - (3.0*e4/64.0) - (5.0*e6/256.0);
-    A2 = (3.0/8.0) * (e2+e4/4.0+15.0*e6/128.0);
-    A4 = (15.0/256.0) * (e4 + 3.0*e6/4.0);
-    A6 = 35.0*e6/3072.0;
+TM_INLINE double meridian_arc_sc( const tmprojection *tm, double lt,
+              double slt, double clt ) {
+    double s2 = 2.0*slt*clt;
+    double c2 = 2.0*(clt-slt)*(clt+slt);
+    double y3, y2, y1;
+
+    /* Clenshaw sum of -A2*sin(2lt)+A4*sin(4lt)-A6*sin(6lt), c2 being
+       2*cos(2lt) */
+
+    y3 = -tm->A6;
+    y2 = tm->A4 + c2*y3;
+    y1 = -tm->A2 + c2*y2 - y3;
+
+    return  tm->a*(tm->A0*lt + y1*s2);
+    }
 
-    return  a*(A0*lt-A2*sin(2*lt)+A4*sin(4*lt)-A6*sin(6*lt));
+static double meridian_arc( const tmprojection *tm, double lt ) {
+    return meridian_arc_sc( tm, lt, sin(lt), cos(lt) );
     }
 
 /*************************************************************************/
@@ -92,46 +243,113 @@ static double meridian_arc( tmprojection *tm, double lt ) {
 /*   foot_point_lat                                                      */
 /*                                                                       */
 /*   Calculates the foot point latitude from the meridional arc          */
+/*   using the coefficients calculated by define_tmprojection            */
 /*   Method based on Redfearn's formulation as expressed in GDA technical*/
 /*   manual at http://www.anzlic.org.au/icsm/gdatm/index.html            */
 /*                                                                       */
+/*   The series in sin(2*sig) to sin(8*sig) is summed with Clenshaw's    */
+/*   recurrence from the sin and cos of sig.  The sin and cos of the     */
+/*   foot point latitude are then found by rotating these by the small   */
+/*   correction (less than 0.003 radians), so only one sin and cos are   */
+/*   evaluated.                                                          */
+/*                                                                       */
 /*   Takes parameters                                                    */
 /*      tm definition (for scale factor)                                 */
 /*      meridional arc (metres)                                          */
+/*      output sin and cos of the foot point latitude                    */
+/*                                                                       */
+/*   Returns the foot point latitude (radians)                           */
 /*                                                                       */
-/*   Returns the foot point latitude (radians)                           */ /*                                                                       */
 /*************************************************************************/
 
 
-static double foot_point_lat( tmprojection *tm, double m ) {
-    double f = tm->f;
-    double a = tm->a;
-    double n;
-    double n2;
-    double n3;
-    double n4;
-    double g;
-    double sig;
-    double phio;
+TM_INLINE double foot_point_lat( const tmprojection *tm, double m,
+              double *slt, double *clt ) {
+    double sig, ssig, csig, s2, c2;
+    double y4, y3, y2, y1;
+    double d, d2, sd, cd;
  
-    n  = f/(2.0-f);
-    n2 = n*n;
-    n3 = n2*n;
-    n4 = n2*n2;
- 
-    g = a*(1.0-n)*(1.0-n2)*(1+9.0*n2/4.0+225.0*n4/64.0);
-    sig = m/g;
- 
-    phio = sig + (3.0*n/2.0 - 27.0*n3/32.0)*sin(2.0*sig)
-                    + (21.0*n2/16.0 - 55.0*n4/32.0)*sin(4.0*sig)
-                    + (151.0*n3/96.0) * sin(6.0*sig)
-                    + (1097.0*n4/512.0) * sin(8.0*sig);
+    sig = m/tm->g;
+    ssig = sin(sig);
+    csig = cos(sig);
+    s2 = 2.0*ssig*csig;
+    c2 = 2.0*(csig-ssig)*(csig+ssig);
+
+    y4 = tm->fp8;
+    y3 = tm->fp6 + c2*y4;
+    y2 = tm->fp4 + c2*y3 - y4;
+    y1 = tm->fp2 + c2*y2 - y3;
+    d = y1*s2;
+
+    d2 = d*d;
+    sd = d*(1.0-d2/6.0*(1.0-d2/20.0));
+    cd = 1.0-d2/2.0*(1.0-d2/12.0*(1.0-d2/30.0));
+    *slt = ssig*cd + csig*sd;
+    *clt = csig*cd - ssig*sd;
  
-    return phio;
-   }
+    return sig + d;
+    }
+
+
+
+
+
+/***************************************************************************/
+/*                                                                         */
+/*   scale_conv_calc                                                       */
+/*                                                                         */
+/*   Calculates the point scale factor and grid convergence using          */
+/*   Redfearn's formulae, as expressed in the GDA technical manual.  The   */
+/*   convergence is the bearing of grid north clockwise from true north   */
+/*   (so is negative east of the central meridian in the southern         */
+/*   hemisphere).                                                          */
+/*                                                                         */
+/*   Takes parameters                                                      */
+/*      sin and cos of the latitude                                        */
+/*      longitude relative to the central meridian (radians)              */
+/*      output point scale factor                                          */
+/*      output convergence (radians)                                       */
+/*                                                                         */
+/***************************************************************************/
+
+static void scale_conv_calc( const tmprojection *tm, double slt, double clt,
+              double dlon, double *k, double *conv ) {
+    double psi;
+    double wc2;
+    double t2;
+    double t4;
+    double trm1;
+    double trm2;
+    double trm3;
+
+    /* psi is the ratio of the radii of curvature, nu/rho */
+
+    psi = (1.0-tm->e2*slt*slt)/(1.0-tm->e2);
+    wc2 = clt*dlon*clt*dlon;
+    t2 = (slt*slt)/(clt*clt);
+    t4 = t2*t2;
+
+    trm1 = psi/2.0;
+
+    trm2 = ((4.0*(1.0-6.0*t2)*psi 
+               + (1.0+24.0*t2))*psi
+               - 4.0*t2)*psi/24.0;
+
+    trm3 = (61.0-148.0*t2+16.0*t4)/720.0;
 
+    *k = tm->scalef*(((trm3*wc2+trm2)*wc2+trm1)*wc2+1.0);
 
+    trm1 = (2.0*psi-1.0)*psi/3.0;
 
+    trm2 = ((((11.0-24.0*t2)*psi
+               -(11.0-36.0*t2))*psi
+               +2.0*(1.0-7.0*t2))*psi
+               +t2)*psi/15.0;
+
+    trm3 = (17.0-26.0*t2+2.0*t4)/315.0;
+
+    *conv = dlon*slt*(((trm3*wc2+trm2)*wc2+trm1)*wc2+1.0);
+    }
 
 
 /***************************************************************************/
@@ -142,89 +360,130 @@ static double foot_point_lat( tmprojection *tm, double m ) {
 /*   Method based on Redfearn's formulation as expressed in GDA technical  */
 /*   manual at http://www.anzlic.org.au/icsm/gdatm/index.html              */
 /*                                                                         */
+/*   The terms that depend only on the northing (the foot point latitude   */
+/*   and the coefficients of the series in the easting) are calculated by  */
+/*   tm_row_terms, and the series are evaluated for an easting by          */
+/*   tm_row_point, so that tm_geod_row can calculate them once for a row   */
+/*   of points with the same northing.                                     */
+/*                                                                         */
 /*   Takes parameters                                                      */
 /*      input easting (metres)                                             */
 /*      input northing (metres)                                            */
 /*      output latitude (radians)                                          */
 /*      output longitude (radians)                                         */
+/*      output point scale factor and convergence (radians), or NULL if    */
+/*         these are not required (both must be NULL or not NULL)          */
 /*                                                                         */
 /***************************************************************************/
 
-static void tm_geod( tmprojection *tm,
-              double ce, double cn, double *ln, double *lt ) {
+typedef struct {
+    double fphi;              /* Foot point latitude */
+    double slt, clt;          /* Its sin and cos */
+    double eta, rho, t;
+    double lt2, lt3, lt4;     /* Coefficients of the latitude series */
+    double ln2, ln3, ln4;     /* Coefficients of the longitude series */
+    } tmrow;
+
+TM_INLINE void tm_row_terms( const tmprojection *tm, double cn, tmrow *row ) {
     double fn = tm->falsen;
-    double fe = tm->falsee;
     double sf = tm->scalef;
     double e2 = tm->e2;
     double a = tm->a;
-    double cm = tm->meridian;
     double om = tm->om;
     double utom = tm->utom;
     double cn1;
-    double fphi;
     double slt;
     double clt;
     double eslt;
     double eta;
     double rho;
     double psi;
-    double E;
-    double x;
-    double x2;
     double t;
     double t2;
     double t4;
-    double trm1;
-    double trm2;
-    double trm3;
-    double trm4;
  
     cn1  =  (cn - fn)*utom/sf + om;
-    fphi = foot_point_lat(tm, cn1);
-    slt = sin(fphi);
-    clt = cos(fphi);
+    row->fphi = foot_point_lat(tm, cn1, &slt, &clt);
  
     eslt = (1.0-e2*slt*slt);
     eta = a/sqrt(eslt);
     rho = eta * (1.0-e2) / eslt;
     psi = eta/rho;
  
-    E = (ce-fe)*utom;
-    x = E/(eta*sf);
-    x2 = x*x;
- 
- 
     t = slt/clt;
     t2 = t*t;
     t4 = t2*t2;
  
-    trm1 = 1.0/2.0;
- 
-    trm2 = ((-4.0*psi
+    row->lt2 = ((-4.0*psi
                  +9.0*(1-t2))*psi
                  +12.0*t2)/24.0;
  
-    trm3 = ((((8.0*(11.0-24.0*t2)*psi
+    row->lt3 = ((((8.0*(11.0-24.0*t2)*psi
                   -12.0*(21.0-71.0*t2))*psi
                   +15.0*((15.0*t2-98.0)*t2+15))*psi
                   +180.0*((-3.0*t2+5.0)*t2))*psi + 360.0*t4)/720.0;
  
-    trm4 = (((1575.0*t2+4095.0)*t2+3633.0)*t2+1385.0)/40320.0;
- 
-    *lt = fphi+(t*x*E/(sf*rho))*(((trm4*x2-trm3)*x2+trm2)*x2-trm1);
- 
-    trm1 = 1.0;
+    row->lt4 = (((1575.0*t2+4095.0)*t2+3633.0)*t2+1385.0)/40320.0;
  
-    trm2 = (psi+2.0*t2)/6.0;
+    row->ln2 = (psi+2.0*t2)/6.0;
  
-    trm3 = (((-4.0*(1.0-6.0*t2)*psi
+    row->ln3 = (((-4.0*(1.0-6.0*t2)*psi
                +(9.0-68.0*t2))*psi
                +72.0*t2)*psi
                +24.0*t4)/120.0;
  
-    trm4 = (((720.0*t2+1320.0)*t2+662.0)*t2+61.0)/5040.0;
+    row->ln4 = (((720.0*t2+1320.0)*t2+662.0)*t2+61.0)/5040.0;
+
+    row->slt = slt;
+    row->clt = clt;
+    row->eta = eta;
+    row->rho = rho;
+    row->t = t;
+    }
+
+TM_INLINE void tm_row_point( const tmprojection *tm, const tmrow *row,
+              double ce, double *ln, double *lt ) {
+    double sf = tm->scalef;
+    double E;
+    double x;
+    double x2;
+ 
+    E = (ce-tm->falsee)*tm->utom;
+    x = E/(row->eta*sf);
+    x2 = x*x;
+ 
+    *lt = row->fphi+(row->t*x*E/(sf*row->rho))
+                    *(((row->lt4*x2-row->lt3)*x2+row->lt2)*x2-1.0/2.0);
  
-    *ln = cm - (x/clt)*(((trm4*x2-trm3)*x2+trm2)*x2-trm1);
+    *ln = tm->meridian 
+              - (x/row->clt)*(((row->ln4*x2-row->ln3)*x2+row->ln2)*x2-1.0);
+    }
+
+TM_INLINE void tm_geod_calc( const tmprojection *tm,
+              double ce, double cn, double *ln, double *lt,
+              double *k, double *conv ) {
+    tmrow row;
+
+    tm_row_terms( tm, cn, &row );
+    tm_row_point( tm, &row, ce, ln, lt );
+
+    /* The scale factor and convergence are calculated from the latitude
+       and longitude, as this is more accurate than the series in terms
+       of the foot point latitude.  The sin and cos of the latitude are
+       calculated from those of the foot point latitude, as the 
+       difference d is small (less than 0.01 radians within 600km of 
+       the central meridian) */
+
+    if( k ) {
+       double slt = row.slt;
+       double clt = row.clt;
+       double d = *lt - row.fphi;
+       double d2 = d*d;
+       double sd = d*(1.0-d2/6.0*(1.0-d2/20.0*(1.0-d2/42.0)));
+       double cd = 1.0-d2/2.0*(1.0-d2/12.0*(1.0-d2/30.0));
+       scale_conv_calc( tm, slt*cd+clt*sd, clt*cd-slt*sd, 
+                        *ln - tm->meridian, k, conv );
+       }
     }
 
 
@@ -237,26 +496,29 @@ static void tm_geod( tmprojection *tm,
 /*   manual at http://www.anzlic.org.au/icsm/gdatm/index.html              */
 /*   Loosely based on FORTRAN source code by J.Hannah and A.Broadhurst.    */
 /*                                                                         */
+/*   geod_tm_calc takes the longitude relative to the central meridian,    */
+/*   which is calculated by geod_tm and geod_tm_batch                      */
+/*                                                                         */
 /*   Takes parameters                                                      */
 /*      input latitude (radians)                                           */
 /*      input longitude (radians)                                          */
 /*      output easting  (metres)                                           */
 /*      output northing (metres)                                           */
+/*      output point scale factor and convergence (radians), or NULL      */
 /*                                                                         */
 /***************************************************************************/
 
 
-static void geod_tm( tmprojection *tm,
-              double ln, double lt, double *ce, double *cn) {
+TM_INLINE void geod_tm_calc( const tmprojection *tm,
+              double dlon, double lt, double *ce, double *cn,
+              double *k, double *conv ) {
     double fn = tm->falsen;
     double fe = tm->falsee;
     double sf = tm->scalef;
     double e2 = tm->e2;
     double a = tm->a;
-    double cm = tm->meridian;
     double om = tm->om;
     double utom = tm->utom;
-    double dlon;
     double m;
     double slt;
     double eslt;
@@ -278,20 +540,16 @@ static void geod_tm( tmprojection *tm,
     double trm4;
     double gcn;
  
-    dlon  =  ln - cm;
-    while ( dlon > PI ) dlon -= TWOPI;
-    while ( dlon < -PI ) dlon += TWOPI;
- 
-    m = meridian_arc(tm,lt);
- 
     slt = sin(lt);
+    clt = cos(lt);
+ 
+    m = meridian_arc_sc(tm,lt,slt,clt);
  
     eslt = (1.0-e2*slt*slt);
     eta = a/sqrt(eslt);
     rho = eta * (1.0-e2) / eslt;
     psi = eta/rho;
  
-    clt = cos(lt);
     w = dlon;
  
     wc = clt*w;
@@ -328,62 +586,1997 @@ static void geod_tm( tmprojection *tm,
     gcn = (eta*t)*((((trm4*wc2+trm3)*wc2+trm2)*wc2+trm1)*wc2);
     *cn = (gcn+m-om)*sf/utom+fn;
 
+    if( k ) scale_conv_calc( tm, slt, clt, dlon, k, conv );
+
    return;
    }
 
-/* Define a static implementation of tmprojection */
-/* Note: for some implementations it may be better to create this
-   dynamically and develop modified versions of the transformation
-   functions to take this as a parameter */
 
-static tmprojection nztm_projection;
-static int initiallized = 0;
+/***************************************************************************/
+/*                                                                         */
+/*   kruger_sum                                                            */
+/*                                                                         */
+/*   Evaluates the sum of c[j-1]*sin(2*j*zeta) for j = 1 to              */
+/*   TM_KRUGER_ORDER, where zeta = xi + i*eta is complex, using Clenshaw   */
+/*   summation.  This needs only one evaluation of sin, cos, sinh, and    */
+/*   cosh, instead of one for each term.  Optionally also evaluates the   */
+/*   derivative of the sum with respect to zeta, which is used for the    */
+/*   scale factor and convergence.                                        */
+/*                                                                         */
+/*   Takes parameters                                                      */
+/*      coefficients of the series                                        */
+/*      real and imaginary parts of zeta                                  */
+/*      output real and imaginary parts of the sum                        */
+/*      output real and imaginary parts of the derivative, or NULL        */
+/*                                                                         */
+/***************************************************************************/
+
+static void kruger_sum( const double *c, double xi, double eta,
+              double *sxi, double *seta, double *dxi, double *deta ) {
+    double s2 = sin(2.0*xi);
+    double c2 = cos(2.0*xi);
+    double sh2 = sinh(2.0*eta);
+    double ch2 = cosh(2.0*eta);
+    double ar, ai;          /* 2*cos(2*zeta) */
+    double y1r = 0.0, y1i = 0.0;
+    double y2r = 0.0, y2i = 0.0;
+    double yr, yi;
+    int j;
+
+    ar = 2.0*c2*ch2;
+    ai = -2.0*s2*sh2;
 
-static tmprojection *get_nztm_projection( void )
-{
-   if( ! initiallized )
-   {
-       define_tmprojection( &nztm_projection, NZTM_A, NZTM_RF,
-           NZTM_CM/rad2deg, NZTM_SF, NZTM_OLAT/rad2deg, NZTM_FE, NZTM_FN,
-           1.0);
-       initiallized = 1;
+    for( j = TM_KRUGER_ORDER-1; j >= 0; j-- ) {
+       yr = ar*y1r - ai*y1i - y2r + c[j];
+       yi = ar*y1i + ai*y1r - y2i;
+       y2r = y1r; y2i = y1i;
+       y1r = yr;  y1i = yi;
+       }
+
+    /* Multiply by sin(2*zeta) */
+
+    *sxi = y1r*s2*ch2 - y1i*c2*sh2;
+    *seta = y1r*c2*sh2 + y1i*s2*ch2;
+
+    /* The derivative is the sum of 2*j*c[j-1]*cos(2*j*zeta), which is
+       summed in the same way (the final step uses cos(2*zeta) = a/2) */
+
+    if( dxi ) {
+       y1r = y1i = y2r = y2i = 0.0;
+       for( j = TM_KRUGER_ORDER-1; j >= 0; j-- ) {
+          yr = ar*y1r - ai*y1i - y2r + 2.0*(j+1)*c[j];
+          yi = ar*y1i + ai*y1r - y2i;
+          y2r = y1r; y2i = y1i;
+          y1r = yr;  y1i = yi;
+          }
+       *dxi = (ar*y1r - ai*y1i)/2.0 - y2r;
+       *deta = (ar*y1i + ai*y1r)/2.0 - y2i;
+       }
+    }
+
+/* Inverse hyperbolic functions.  atanh and asinh are not in ANSI C,
+   so are calculated from log.  The absolute error of these is a few
+   units in the last place, which is all that is needed here. */
+
+static double atanh_c89( double x ) {
+    return 0.5*log( (1.0 + x)/(1.0 - x) );
+    }
+
+static double asinh_c89( double x ) {
+    double y = log( fabs(x) + sqrt(1.0 + x*x) );
+    return x < 0.0 ? -y : y;
+    }
+
+/* Returns the tangent of the conformal latitude given the tangent of
+   the latitude, for an ellipsoid with eccentricity e */
+
+static double conformal_tau( double e, double tau ) {
+    double tau1 = sqrt(1.0 + tau*tau);
+    double sig = sinh( e*atanh_c89( e*tau/tau1 ) );
+    return tau*sqrt(1.0 + sig*sig) - sig*tau1;
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_kruger, geod_tm_kruger                                        */
+/*                                                                         */
+/*   Convert between Transverse Mercator and latitude and longitude using  */
+/*   the Kruger series in the third flattening, as described in            */
+/*   C.F.F. Karney, Transverse Mercator with an accuracy of a few          */
+/*   nanometers, J. Geodesy 85(8), 475-485 (2011).                         */
+/*                                                                         */
+/*   The parameters are the same as those of tm_geod_calc and             */
+/*   geod_tm_calc.                                                        */
+/*                                                                         */
+/***************************************************************************/
+
+static void tm_geod_kruger( const tmprojection *tm,
+              double ce, double cn, double *ln, double *lt,
+              double *k, double *conv ) {
+    double e = tm->e;
+    double e2m = 1.0 - tm->e2;
+    double scale = tm->utom/(tm->scalef*tm->A);
+    double xi, eta, sxi, seta, dxi, deta;
+    double sxip, cxip, shetap;
+    double taup, tau, tau1, taupi, dtau, tol;
+    int i;
+
+    xi = (cn - tm->falsen)*scale + tm->xi0;
+    eta = (ce - tm->falsee)*scale;
+
+    kruger_sum( tm->beta, xi, eta, &sxi, &seta, 
+                k ? &dxi : 0, &deta );
+    xi -= sxi;
+    eta -= seta;
+
+    sxip = sin(xi);
+    cxip = cos(xi);
+    shetap = sinh(eta);
+    taup = sxip/sqrt(shetap*shetap + cxip*cxip);
+
+    /* Solve for the tangent of the latitude with Newton's method. 
+       This converges quadratically, so once the correction is below
+       the square root of the required precision one more iteration
+       is sufficient */
+
+    tau = taup/e2m;
+    tol = 1.0e-9 * (fabs(taup) > 1.0 ? fabs(taup) : 1.0);
+    for( i = 0; i < 5; i++ ) {
+       tau1 = sqrt(1.0 + tau*tau);
+       taupi = conformal_tau( e, tau );
+       dtau = (taup - taupi)/sqrt(1.0 + taupi*taupi)
+              * (1.0 + e2m*tau*tau)/(e2m*tau1);
+       tau += dtau;
+       if( fabs(dtau) < tol ) break;
+       }
+
+    *lt = atan(tau);
+    *ln = tm->meridian + atan2(shetap, cxip);
+
+    /* Scale factor and convergence of the Gauss-Schreiber projection
+       (from zeta'), combined with those of the mapping from zeta to 
+       zeta', which has derivative 1 - dxi - i*deta */
+
+    if( k ) {
+       double r = sqrt(shetap*shetap + cxip*cxip);
+       double p = 1.0 - dxi;
+       double q = -deta;
+       *k = tm->scalef*tm->A/tm->a * sqrt(e2m + tm->e2/(1.0+tau*tau))
+            * sqrt(1.0 + tau*tau) * r / sqrt(p*p + q*q);
+       *conv = atan2( sxip*tanh(eta), cxip ) + atan2( q, p );
+       }
+    }
+
+static void geod_tm_kruger( const tmprojection *tm,
+              double dlon, double lt, double *ce, double *cn,
+              double *k, double *conv ) {
+    double scale = tm->scalef*tm->A/tm->utom;
+    double tau, taup, clon, slon, xi, eta, sxi, seta, dxi, deta;
+
+    tau = tan(lt);
+    taup = conformal_tau( tm->e, tau );
+    clon = cos(dlon);
+    slon = sin(dlon);
+    xi = atan2( taup, clon );
+    eta = asinh_c89( slon/sqrt(taup*taup + clon*clon) );
+
+    kruger_sum( tm->alpha, xi, eta, &sxi, &seta, k ? &dxi : 0, &deta );
+
+    *ce = (eta + seta)*scale + tm->falsee;
+    *cn = (xi + sxi - tm->xi0)*scale + tm->falsen;
+
+    /* Scale factor and convergence of the Gauss-Schreiber projection,
+       combined with those of the series, which has derivative
+       1 + dxi + i*deta */
+
+    if( k ) {
+       double p = 1.0 + dxi;
+       double q = deta;
+       *k = tm->scalef*tm->A/tm->a 
+            * sqrt(1.0 - tm->e2 + tm->e2/(1.0+tau*tau)) * sqrt(1.0+tau*tau)
+            / sqrt(taup*taup + clon*clon) * sqrt(p*p + q*q);
+       *conv = atan2( slon*taup, clon*sqrt(1.0+taup*taup) ) - atan2( q, p );
+       }
+    }
+
+void tm_geod( const tmprojection *tm,
+              double ce, double cn, double *ln, double *lt ) {
+   if( tm->approx && approx_calc( tm->approx, 1, ce, cn, ln, lt ) ) return;
+
+   if( tm->method == TM_KRUGER ) {
+      tm_geod_kruger( tm, ce, cn, ln, lt, 0, 0 );
+      }
+   else {
+      tm_geod_calc( tm, ce, cn, ln, lt, 0, 0 );
+      }
    }
-   return &nztm_projection;
-}
 
-/* Functions implementation the TM projection specifically for the
-   NZTM coordinate system
-*/
+void geod_tm( const tmprojection *tm,
+              double ln, double lt, double *ce, double *cn) {
+    double dlon;
 
-void nztm_geod( double n, double e, double *lt, double *ln )
-{
-   tmprojection *nztm = get_nztm_projection();
-   tm_geod( nztm, e, n, ln, lt );
-}
+    dlon  =  wrap_dlon( ln - tm->meridian );
 
-void geod_nztm( double lt, double ln, double *n, double *e )
-{
-   tmprojection *nztm = get_nztm_projection();
-   geod_tm( nztm, ln, lt, e, n );
-}
+    if( tm->approx && approx_calc( tm->approx, 0, dlon, lt, ce, cn ) ) return;
 
-#ifdef TEST_NZTM
+    if( tm->method == TM_KRUGER ) {
+       geod_tm_kruger( tm, dlon, lt, ce, cn, 0, 0 );
+       }
+    else {
+       geod_tm_calc( tm, dlon, lt, ce, cn, 0, 0 );
+       }
+    }
 
-#include <stdio.h>
 
-int main( int argc, char *argv[] ) {
-  double e, n, lt, ln, e1, n1;
-  while(1) {
-     printf("Enter NZTM easting, northing: ");
-     if( scanf("%lf%lf",&e,&n) != 2 ) break;
-     nztm_geod( n, e, &lt, &ln );
-     geod_nztm( lt, ln, &n1, &e1 );
-     printf("\nInput NZTM e,n:  %12.3lf %12.3lf\n",e,n);
-     printf("Output Lat/Long: %12.6lf %12.6lf\n",lt*rad2deg,ln*rad2deg);
-     printf("Output NZTM e,n: %12.3lf %12.3lf\n",e1,n1);
-     printf("Difference:      %12.3lf %12.3lf\n\n",e1-e,n1-n);
-     }
-  return 0;
-  }
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_batch, geod_tm_batch                                          */
+/*                                                                         */
+/*   Convert arrays of points between Transverse Mercator and latitude and */
+/*   longitude, using the same calculation as tm_geod and geod_tm.  The    */
+/*   projection is copied into a local structure, so that the compiler    */
+/*   can keep its constants in registers rather than reloading them in    */
+/*   case they are changed by writing the output arrays.                  */
+/*                                                                         */
+/*   Each array is accessed with a stride, the number of doubles between   */
+/*   successive points, so that the routines can be used with separate    */
+/*   arrays for each coordinate (stride 1) or with arrays of points        */
+/*   (for example stride 2 for easting/northing pairs).  The outputs may   */
+/*   overwrite the inputs of the same point.                               */
+/*                                                                         */
+/*   If compiled with NZTM_SIMD defined, contiguous arrays (both strides  */
+/*   1) are converted with the vector routines in nztmsimd.c, if the      */
+/*   processor supports them.  The results then differ from tm_geod and   */
+/*   geod_tm by rounding error.                                           */
+/*                                                                         */
+/*   Takes parameters                                                      */
+/*      number of points                                                   */
+/*      input easting and northing (metres), or longitude and latitude    */
+/*         (radians)                                                       */
+/*      input stride                                                       */
+/*      output longitude and latitude, or easting and northing             */
+/*      output stride                                                      */
+/*                                                                         */
+/***************************************************************************/
+
+static void tm_geod_array( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, int instride,
+              double *ln, double *lt, double *k, double *conv, 
+              int outstride ) {
+    tmprojection tmc = *tm;
+    int i;
+
+#define OUTPTR(p) (p ? p + i*outstride : 0)
+
+    if( tmc.approx && ! k ) {
+       for( i = 0; i < npt; i++ ) {
+          tm_geod( &tmc, ce[i*instride], cn[i*instride],
+                   ln + i*outstride, lt + i*outstride );
+          }
+       return;
+       }
+
+    if( tmc.method == TM_KRUGER ) {
+       for( i = 0; i < npt; i++ ) {
+          tm_geod_kruger( &tmc, ce[i*instride], cn[i*instride],
+                          ln + i*outstride, lt + i*outstride,
+                          OUTPTR(k), OUTPTR(conv) );
+          }
+       return;
+       }
+
+#ifdef NZTM_SIMD
+    if( instride == 1 && outstride == 1 && ! k &&
+        tm_geod_simd( &tmc, npt, ce, cn, ln, lt ) ) return;
+#endif
+
+    if( ! k && tm_geod_special( tm, npt, ce, cn, instride, 
+                                ln, lt, outstride ) ) return;
+
+    for( i = 0; i < npt; i++ ) {
+       tm_geod_calc( &tmc, ce[i*instride], cn[i*instride],
+                     ln + i*outstride, lt + i*outstride,
+                     OUTPTR(k), OUTPTR(conv) );
+       }
+    }
+
+static void geod_tm_array( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, int instride,
+              double *ce, double *cn, double *k, double *conv,
+              int outstride ) {
+    tmprojection tmc = *tm;
+    double cm = tm->meridian;
+    double dlon;
+    int i;
+
+    if( tmc.approx && ! k ) {
+       for( i = 0; i < npt; i++ ) {
+          geod_tm( &tmc, ln[i*instride], lt[i*instride],
+                   ce + i*outstride, cn + i*outstride );
+          }
+       return;
+       }
+
+    if( tmc.method == TM_KRUGER ) {
+       for( i = 0; i < npt; i++ ) {
+          dlon = wrap_dlon( ln[i*instride] - cm );
+          geod_tm_kruger( &tmc, dlon, lt[i*instride],
+                          ce + i*outstride, cn + i*outstride,
+                          OUTPTR(k), OUTPTR(conv) );
+          }
+       return;
+       }
+
+#ifdef NZTM_SIMD
+    if( instride == 1 && outstride == 1 && ! k &&
+        geod_tm_simd( &tmc, npt, ln, lt, ce, cn ) ) return;
+#endif
+
+    if( ! k && geod_tm_special( tm, npt, ln, lt, instride, 
+                                ce, cn, outstride ) ) return;
+
+    for( i = 0; i < npt; i++ ) {
+       dlon = wrap_dlon( ln[i*instride] - cm );
+       geod_tm_calc( &tmc, dlon, lt[i*instride],
+                     ce + i*outstride, cn + i*outstride,
+                     OUTPTR(k), OUTPTR(conv) );
+       }
+
+#undef OUTPTR
+    }
+
+void tm_geod_batch( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, int instride,
+              double *ln, double *lt, int outstride ) {
+    tm_geod_array( tm, npt, ce, cn, instride, ln, lt, 0, 0, outstride );
+    }
+
+void geod_tm_batch( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, int instride,
+              double *ce, double *cn, int outstride ) {
+    geod_tm_array( tm, npt, ln, lt, instride, ce, cn, 0, 0, outstride );
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_scale_batch, geod_tm_scale_batch                              */
+/*                                                                         */
+/*   As tm_geod_batch and geod_tm_batch, but also return the point scale   */
+/*   factor and grid convergence of each point, calculated from the same  */
+/*   intermediate values as the coordinates.  The convergence is the      */
+/*   bearing of grid north clockwise from true north, in radians.  The    */
+/*   scale factor and convergence arrays use the output stride.  These    */
+/*   do not use the vector routines.                                       */
+/*                                                                         */
+/***************************************************************************/
+
+void tm_geod_scale_batch( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, int instride,
+              double *ln, double *lt, double *k, double *conv, 
+              int outstride ) {
+    tm_geod_array( tm, npt, ce, cn, instride, ln, lt, k, conv, outstride );
+    }
+
+void geod_tm_scale_batch( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, int instride,
+              double *ce, double *cn, double *k, double *conv,
+              int outstride ) {
+    geod_tm_array( tm, npt, ln, lt, instride, ce, cn, k, conv, outstride );
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_row                                                           */
+/*                                                                         */
+/*   Converts a row of points with the same northing (for example a row    */
+/*   of pixels of a raster being reprojected) from TM to latitude and      */
+/*   longitude.  The foot point latitude and the coefficients of the       */
+/*   series in the easting are calculated once for the row, so only the    */
+/*   series are evaluated for each point.  The results are identical to    */
+/*   tm_geod.  Projections using TM_KRUGER or an approximation convert     */
+/*   each point with tm_geod.  The outputs may overwrite the eastings.     */
+/*                                                                         */
+/***************************************************************************/
+
+void tm_geod_row( const tmprojection *tm, double cn, int npt,
+              const double *ce, double *ln, double *lt ) {
+    tmprojection tmc = *tm;
+    tmrow row;
+    int i;
+
+    if( tmc.method == TM_KRUGER || tmc.approx ) {
+       for( i = 0; i < npt; i++ ) tm_geod( &tmc, ce[i], cn, ln+i, lt+i );
+       return;
+       }
+
+    tm_row_terms( &tmc, cn, &row );
+    for( i = 0; i < npt; i++ ) {
+       tm_row_point( &tmc, &row, ce[i], ln+i, lt+i );
+       }
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   geod_tm_fixed, geod_tm_fixed32                                        */
+/*                                                                         */
+/*   Convert arrays of latitude and longitude to fixed point (integer) TM  */
+/*   coordinates, for example integer millimetres.  The outputs are        */
+/*   (ce-ce0)*scale and (cn-cn0)*scale rounded to the nearest integer      */
+/*   (ties to even).  geod_tm_fixed32 is for offsets from a local origin   */
+/*   that fit in an int, and halves the size of the output.  Points are    */
+/*   converted with geod_tm_batch in chunks of TM_FIXED_CHUNK points, and  */
+/*   each chunk is rounded in a loop that compilers can vectorise, so      */
+/*   there is no second pass over the data.  The outputs are not defined   */
+/*   for points that cannot be converted or are out of range.              */
+/*                                                                         */
+/***************************************************************************/
+
+#define TM_FIXED_CHUNK 256
+
+void geod_tm_fixed( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, 
+              double ce0, double cn0, double scale,
+              long long *ce, long long *cn ) {
+    double bce[TM_FIXED_CHUNK], bcn[TM_FIXED_CHUNK];
+    int i, j, nb;
+
+    for( i = 0; i < npt; i += TM_FIXED_CHUNK ) {
+       nb = npt - i < TM_FIXED_CHUNK ? npt - i : TM_FIXED_CHUNK;
+       geod_tm_batch( tm, nb, ln+i, lt+i, 1, bce, bcn, 1 );
+       for( j = 0; j < nb; j++ ) {
+          ce[i+j] = (long long) round_nearest( (bce[j]-ce0)*scale );
+          cn[i+j] = (long long) round_nearest( (bcn[j]-cn0)*scale );
+          }
+       }
+    }
+
+void geod_tm_fixed32( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, 
+              double ce0, double cn0, double scale,
+              int *ce, int *cn ) {
+    double bce[TM_FIXED_CHUNK], bcn[TM_FIXED_CHUNK];
+    int i, j, nb;
+
+    for( i = 0; i < npt; i += TM_FIXED_CHUNK ) {
+       nb = npt - i < TM_FIXED_CHUNK ? npt - i : TM_FIXED_CHUNK;
+       geod_tm_batch( tm, nb, ln+i, lt+i, 1, bce, bcn, 1 );
+       for( j = 0; j < nb; j++ ) {
+          ce[i+j] = (int) round_nearest( (bce[j]-ce0)*scale );
+          cn[i+j] = (int) round_nearest( (bcn[j]-cn0)*scale );
+          }
+       }
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   define_tmframe, tm_geod_frame, geod_tm_frame                          */
+/*                                                                         */
+/*   Single precision conversions in a local frame.  A float has a 24 bit  */
+/*   mantissa, so cannot hold NZTM coordinates to better than about half   */
+/*   a metre, but can hold offsets of up to 50km from a local origin to    */
+/*   about a centimetre.  Within the frame each conversion is              */
+/*   approximated by a polynomial in the offsets, by interpolating the     */
+/*   double precision routines at Chebyshev nodes.  The lowest total       */
+/*   degree (up to TM_FRAME_DEGREE) that fits to TM_FRAME_TOLERANCE is     */
+/*   used.  The frame routines then need no transcendental functions.      */
+/*                                                                         */
+/*   The polynomials are evaluated with Horner's method for blocks of      */
+/*   TM_FRAME_BLOCK points, in loops over the points of the block, which   */
+/*   compilers can vectorise with twice as many floats as doubles in each  */
+/*   vector register.  The linear coefficients are split into a leading    */
+/*   float and a remainder, and the leading part is added last, so that    */
+/*   the result is within about one unit in the last place.                */
+/*                                                                         */
+/*   The outputs may overwrite the inputs.                                 */
+/*                                                                         */
+/***************************************************************************/
+
+#define TM_FRAME_NNODE (TM_FRAME_DEGREE+1)
+#define TM_FRAME_BLOCK 16
+
+/* Truncation error allowed in the frame polynomials (metres), which
+   is well below the precision of a float */
+
+#define TM_FRAME_TOLERANCE 1.0e-4
+
+/* Fits a polynomial to a function f sampled at the Chebyshev nodes of
+   the rectangle with half widths hu and hv (f[k*TM_FRAME_NNODE+l] is 
+   the value at node k of u and node l of v).  Calculates the Chebyshev
+   coefficients of total degree up to TM_FRAME_DEGREE */
+
+static void cheb_fit( const double *f, 
+              double cheb[TM_FRAME_NNODE][TM_FRAME_NNODE] ) {
+    double s;
+    int i, j, k, l;
+
+    for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+       for( j = 0; j < TM_FRAME_NNODE; j++ ) {
+          s = 0.0;
+          if( i + j < TM_FRAME_NNODE ) {
+             for( k = 0; k < TM_FRAME_NNODE; k++ ) {
+                for( l = 0; l < TM_FRAME_NNODE; l++ ) {
+                   s += f[k*TM_FRAME_NNODE+l] 
+                        * cos( i*(k+0.5)*PI/TM_FRAME_NNODE )
+                        * cos( j*(l+0.5)*PI/TM_FRAME_NNODE );
+                   }
+                }
+             s *= 4.0/(TM_FRAME_NNODE*TM_FRAME_NNODE);
+             if( i == 0 ) s /= 2.0;
+             if( j == 0 ) s /= 2.0;
+             }
+          cheb[i][j] = s;
+          }
+       }
+    }
+
+/* Returns the lowest degree for which the sum of the omitted Chebyshev
+   coefficients (which bounds the truncation error) is less than tol */
+
+static int cheb_degree( double cheb[TM_FRAME_NNODE][TM_FRAME_NNODE],
+              double tol ) {
+    double err;
+    int degree, i, j;
+
+    for( degree = 1; degree < TM_FRAME_DEGREE; degree++ ) {
+       err = 0.0;
+       for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+          for( j = 0; i + j < TM_FRAME_NNODE; j++ ) {
+             if( i + j > degree ) err += fabs( cheb[i][j] );
+             }
+          }
+       if( err < tol ) break;
+       }
+    return degree;
+    }
+
+/* Converts the Chebyshev coefficients up to degree to the coefficients
+   pw[p][q] of the powers u^p v^q */
+
+static void cheb_power( double cheb[TM_FRAME_NNODE][TM_FRAME_NNODE],
+              int degree, double pw[TM_FRAME_NNODE][TM_FRAME_NNODE] ) {
+    double tp[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    double s;
+    int i, j, p, q;
+
+    /* Coefficients of the powers of x in the Chebyshev polynomials */
+
+    memset( tp, 0, sizeof(tp) );
+    tp[0][0] = 1.0;
+    tp[1][1] = 1.0;
+    for( i = 2; i < TM_FRAME_NNODE; i++ ) {
+       for( p = 0; p <= i; p++ ) {
+          tp[i][p] = (p > 0 ? 2.0*tp[i-1][p-1] : 0.0) - tp[i-2][p];
+          }
+       }
+
+    for( p = 0; p <= degree; p++ ) {
+       for( q = 0; p + q <= degree; q++ ) {
+          s = 0.0;
+          for( i = p; i <= degree; i++ ) {
+             for( j = q; i + j <= degree; j++ ) {
+                s += cheb[i][j]*tp[i][p]*tp[j][q];
+                }
+             }
+          pw[p][q] = s;
+          }
+       }
+    }
+
+/* Converts the Chebyshev coefficients to float coefficients of the 
+   powers of u and v multiplied by the powers of two scl, which are 
+   chosen close to 1/hu and 1/hv so that the coefficients do not 
+   underflow (the multiplication is exact).  The coefficients are stored
+   in c in the order used by frame_array, except for the leading parts
+   of the coefficients of u and v, which are stored in lin */
+
+static void frame_power( double cheb[TM_FRAME_NNODE][TM_FRAME_NNODE],
+              int degree, double hu, double hv, 
+              float *c, float *lin, const float *scl ) {
+    double pw[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    double s;
+    int p, q;
+
+    cheb_power( cheb, degree, pw );
+
+    for( p = degree; p >= 0; p-- ) {
+       for( q = degree - p; q >= 0; q-- ) {
+          s = pw[p][q] * pow( 1.0/(hu*scl[0]), p ) 
+                       * pow( 1.0/(hv*scl[1]), q );
+          if( p + q == 1 ) {
+             lin[p ? 0 : 1] = (float) s;
+             s -= lin[p ? 0 : 1];
+             }
+          *c++ = (float) s;
+          }
+       }
+    }
+
+/* Fits the two functions f1 and f2 sampled on the rectangle with half 
+   widths hu, hv, and returns the degree used */
+
+static int frame_define( const double *f1, const double *f2, 
+              double hu, double hv, double tol,
+              float (*c)[TM_FRAME_NCOEF], float (*lin)[2], float *scl ) {
+    double cheb1[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    double cheb2[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    int degree, degree2, eu, ev;
+
+    cheb_fit( f1, cheb1 );
+    cheb_fit( f2, cheb2 );
+    degree = cheb_degree( cheb1, tol );
+    degree2 = cheb_degree( cheb2, tol );
+    if( degree2 > degree ) degree = degree2;
+
+    frexp( hu, &eu );
+    frexp( hv, &ev );
+    scl[0] = (float) ldexp( 1.0, 1-eu );
+    scl[1] = (float) ldexp( 1.0, 1-ev );
+    frame_power( cheb1, degree, hu, hv, c[0], lin[0], scl );
+    frame_power( cheb2, degree, hu, hv, c[1], lin[1], scl );
+    return degree;
+    }
+
+/* Evaluates the polynomials for arrays of points, in blocks of 
+   TM_FRAME_BLOCK points.  All of the block arrays are local, so that 
+   the compiler can vectorise the loops over the block */
+
+static void frame_array( const float (*c)[TM_FRAME_NCOEF], 
+              const float (*lin)[2], const float *scl, int degree, int npt,
+              const float *in1, const float *in2, float *out1, float *out2 ) {
+    float u[TM_FRAME_BLOCK], v[TM_FRAME_BLOCK];
+    float r1[TM_FRAME_BLOCK], r2[TM_FRAME_BLOCK];
+    float s1[TM_FRAME_BLOCK], s2[TM_FRAME_BLOCK];
+    const float *c1, *c2;
+    float ci1, ci2;
+    int i, j, p, q, nb;
+
+    for( i = 0; i < npt; i += TM_FRAME_BLOCK ) {
+       nb = npt - i < TM_FRAME_BLOCK ? npt - i : TM_FRAME_BLOCK;
+       for( j = 0; j < TM_FRAME_BLOCK; j++ ) {
+          u[j] = j < nb ? in1[i+j]*scl[0] : 0.0f;
+          v[j] = j < nb ? in2[i+j]*scl[1] : 0.0f;
+          s1[j] = s2[j] = 0.0f;
+          }
+
+       c1 = c[0];
+       c2 = c[1];
+       for( p = degree; p >= 0; p-- ) {
+          ci1 = *c1++;
+          ci2 = *c2++;
+          for( j = 0; j < TM_FRAME_BLOCK; j++ ) {
+             r1[j] = ci1;
+             r2[j] = ci2;
+             }
+          for( q = p; q < degree; q++ ) {
+             ci1 = *c1++;
+             ci2 = *c2++;
+             for( j = 0; j < TM_FRAME_BLOCK; j++ ) {
+                r1[j] = r1[j]*v[j] + ci1;
+                r2[j] = r2[j]*v[j] + ci2;
+                }
+             }
+          for( j = 0; j < TM_FRAME_BLOCK; j++ ) {
+             s1[j] = s1[j]*u[j] + r1[j];
+             s2[j] = s2[j]*u[j] + r2[j];
+             }
+          }
+
+       for( j = 0; j < TM_FRAME_BLOCK; j++ ) {
+          s1[j] = lin[0][0]*u[j] + (lin[0][1]*v[j] + s1[j]);
+          s2[j] = lin[1][0]*u[j] + (lin[1][1]*v[j] + s2[j]);
+          }
+       for( j = 0; j < nb; j++ ) {
+          out1[i+j] = s1[j];
+          out2[i+j] = s2[j];
+          }
+       }
+    }
+
+int define_tmframe( tmframe *fr, const tmprojection *tm,
+              double ce, double cn, double range ) {
+    double f1[TM_FRAME_NNODE*TM_FRAME_NNODE];
+    double f2[TM_FRAME_NNODE*TM_FRAME_NNODE];
+    double node[TM_FRAME_NNODE];
+    double hln, hlt, ln, lt, e, n;
+    int i, j;
+
+    if( ! (range > 0.0) ) return 0;
+
+    fr->ce = ce;
+    fr->cn = cn;
+    fr->range = range;
+    tm_geod( tm, ce, cn, &fr->ln, &fr->lt );
+
+    for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+       node[i] = cos( (i+0.5)*PI/TM_FRAME_NNODE );
+       }
+
+    /* TM to latitude and longitude, fitted over the square */
+
+    for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+       for( j = 0; j < TM_FRAME_NNODE; j++ ) {
+          tm_geod( tm, ce + node[i]*range, cn + node[j]*range, &ln, &lt );
+          f1[i*TM_FRAME_NNODE+j] = ln - fr->ln;
+          f2[i*TM_FRAME_NNODE+j] = lt - fr->lt;
+          }
+       }
+    fr->invdeg = frame_define( f1, f2, range, range, 
+                    TM_FRAME_TOLERANCE/(tm->a*tm->scalef),
+                    fr->inv, fr->invlin, fr->invscl );
+
+    /* Latitude and longitude to TM, fitted over the range of latitude
+       and longitude covered by the square (found from points around 
+       its edges, with a small margin) */
+
+    hln = hlt = 0.0;
+    for( i = -4; i <= 4; i++ ) {
+       for( j = -4; j <= 4; j++ ) {
+          tm_geod( tm, ce + i*range/4, cn + j*range/4, &ln, &lt );
+          if( fabs(ln - fr->ln) > hln ) hln = fabs(ln - fr->ln);
+          if( fabs(lt - fr->lt) > hlt ) hlt = fabs(lt - fr->lt);
+          }
+       }
+    hln *= 1.01;
+    hlt *= 1.01;
+
+    for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+       for( j = 0; j < TM_FRAME_NNODE; j++ ) {
+          geod_tm( tm, fr->ln + node[i]*hln, fr->lt + node[j]*hlt, &e, &n );
+          f1[i*TM_FRAME_NNODE+j] = e - ce;
+          f2[i*TM_FRAME_NNODE+j] = n - cn;
+          }
+       }
+    fr->fwddeg = frame_define( f1, f2, hln, hlt, 
+                    TM_FRAME_TOLERANCE/tm->utom,
+                    fr->fwd, fr->fwdlin, fr->fwdscl );
+
+    return 1;
+    }
+
+void tm_geod_frame( const tmframe *fr, int npt,
+              const float *de, const float *dn, float *dln, float *dlt ) {
+    frame_array( fr->inv, fr->invlin, fr->invscl, fr->invdeg, npt, de, dn, dln, dlt );
+    }
+
+void geod_tm_frame( const tmframe *fr, int npt,
+              const float *dln, const float *dlt, float *de, float *dn ) {
+    frame_array( fr->fwd, fr->fwdlin, fr->fwdscl, fr->fwddeg, npt, dln, dlt, de, dn );
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   create_tmapprox, delete_tmapprox, set_tmprojection_approx             */
+/*                                                                         */
+/*   Piecewise polynomial approximation of a projection over a bounded     */
+/*   extent.  Each conversion is approximated in a grid of cells, in each  */
+/*   of which the exact routine is interpolated at Chebyshev nodes (as     */
+/*   for the frames above) and converted to double precision polynomials   */
+/*   in coordinates scaled to -1 to 1 across the cell.  The number of      */
+/*   cells is doubled in each direction until the polynomials fit to the   */
+/*   requested tolerance with degree at most TM_APPROX_DEGREE, which is    */
+/*   then checked against the exact routine at points across each cell.    */
+/*                                                                         */
+/*   Evaluating an approximation then needs only multiplications and       */
+/*   additions (which compilers can contract into fused multiply-adds),    */
+/*   and no transcendental functions.  Points outside the fitted extent    */
+/*   are converted with the exact routines.                                */
+/*                                                                         */
+/***************************************************************************/
+
+#define TM_APPROX_DEGREE 6
+#define TM_APPROX_MAXCELL 64
+
+/* Number of points across each cell at which the fit is checked */
+
+#define TM_APPROX_NCHECK 5
+
+/* Polynomials of one conversion.  coef holds the coefficients of the 
+   two outputs of each cell in turn, in the order used by approx_calc */
+
+typedef struct {
+    double x0, y0;            /* Lower limits of the fitted extent */
+    double x1, y1;            /* Upper limits of the fitted extent */
+    double sx, sy;            /* Cells per unit of x and y */
+    int nx, ny;               /* Number of cells in x and y */
+    int degree;               /* Degree of the polynomials */
+    int ncoef;                /* Number of coefficients of each output */
+    double *coef;
+    } approx_table;
+
+struct tmapprox_s {
+    approx_table inv;         /* TM to longitude and latitude */
+    approx_table fwd;         /* Longitude offset and latitude to TM */
+    };
+
+/* Evaluates the exact conversion for the table, x and y being easting
+   and northing for the inverse table, or longitude offset and latitude 
+   for the forward table */
+
+static void approx_exact( const tmprojection *tm, int inverse, 
+              double x, double y, double *o1, double *o2 ) {
+    if( inverse ) {
+       tm_geod( tm, x, y, o1, o2 );
+       }
+    else {
+       geod_tm( tm, tm->meridian + x, y, o1, o2 );
+       }
+    }
+
+/* Evaluates the polynomials of a table at x, y.  Returns 0 if the 
+   point is outside the fitted extent (or is not a number) */
+
+static int approx_eval( const approx_table *t, double x, double y,
+              double *o1, double *o2 ) {
+    const double *c1, *c2;
+    double u, v, r1, r2, s1, s2;
+    int ix, iy, p, q, k;
+
+    if( ! (x >= t->x0 && x <= t->x1 && y >= t->y0 && y <= t->y1) ) return 0;
+
+    u = (x - t->x0)*t->sx;
+    v = (y - t->y0)*t->sy;
+    ix = (int) u;
+    iy = (int) v;
+    if( ix >= t->nx ) ix = t->nx - 1;
+    if( iy >= t->ny ) iy = t->ny - 1;
+    u = 2.0*(u - ix) - 1.0;
+    v = 2.0*(v - iy) - 1.0;
+
+    c1 = t->coef + (iy*t->nx + ix)*2*t->ncoef;
+    c2 = c1 + t->ncoef;
+
+    s1 = s2 = 0.0;
+    k = 0;
+    for( p = t->degree; p >= 0; p-- ) {
+       r1 = c1[k];
+       r2 = c2[k];
+       k++;
+       for( q = p; q < t->degree; q++ ) {
+          r1 = r1*v + c1[k];
+          r2 = r2*v + c2[k];
+          k++;
+          }
+       s1 = s1*u + r1;
+       s2 = s2*u + r2;
+       }
+    *o1 = s1;
+    *o2 = s2;
+    return 1;
+    }
+
+static int approx_calc( const tmapprox *ap, int inverse, 
+              double x, double y, double *o1, double *o2 ) {
+    return approx_eval( inverse ? &ap->inv : &ap->fwd, x, y, o1, o2 );
+    }
+
+/* Fits the table with nx by ny cells over its extent.  Returns 0 if 
+   the polynomials do not fit to tol with degree up to TM_APPROX_DEGREE,
+   or memory cannot be allocated */
+
+static int approx_fit( approx_table *t, const tmprojection *tm, 
+              int inverse, int nx, int ny, double tol ) {
+    double f1[TM_FRAME_NNODE*TM_FRAME_NNODE];
+    double f2[TM_FRAME_NNODE*TM_FRAME_NNODE];
+    double pw[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    double node[TM_FRAME_NNODE];
+    double (*cheb)[TM_FRAME_NNODE][TM_FRAME_NNODE];
+    double hx, hy, xc, yc, x, y, o1, o2, e1, e2;
+    double *c;
+    int ncell, cell, degree, d, i, j, p, q;
+
+    ncell = nx*ny;
+    cheb = malloc( ncell*2*sizeof(*cheb) );
+    if( ! cheb ) return 0;
+
+    for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+       node[i] = cos( (i+0.5)*PI/TM_FRAME_NNODE );
+       }
+
+    t->nx = nx;
+    t->ny = ny;
+    t->sx = nx/(t->x1 - t->x0);
+    t->sy = ny/(t->y1 - t->y0);
+    hx = 0.5/t->sx;
+    hy = 0.5/t->sy;
+
+    /* Fit each cell and find the degree needed */
+
+    degree = 1;
+    for( cell = 0; cell < ncell && degree <= TM_APPROX_DEGREE; cell++ ) {
+       xc = t->x0 + (2*(cell % nx) + 1)*hx;
+       yc = t->y0 + (2*(cell / nx) + 1)*hy;
+       for( i = 0; i < TM_FRAME_NNODE; i++ ) {
+          for( j = 0; j < TM_FRAME_NNODE; j++ ) {
+             approx_exact( tm, inverse, xc + node[i]*hx, yc + node[j]*hy,
+                           &f1[i*TM_FRAME_NNODE+j], &f2[i*TM_FRAME_NNODE+j] );
+             }
+          }
+       cheb_fit( f1, cheb[2*cell] );
+       cheb_fit( f2, cheb[2*cell+1] );
+       d = cheb_degree( cheb[2*cell], tol/2 );
+       if( d > degree ) degree = d;
+       d = cheb_degree( cheb[2*cell+1], tol/2 );
+       if( d > degree ) degree = d;
+       }
+
+    if( degree > TM_APPROX_DEGREE ) {
+       free( cheb );
+       return 0;
+       }
+
+    t->degree = degree;
+    t->ncoef = (degree+1)*(degree+2)/2;
+    free( t->coef );
+    t->coef = malloc( ncell*2*t->ncoef*sizeof(double) );
+    if( ! t->coef ) {
+       free( cheb );
+       return 0;
+       }
+
+    c = t->coef;
+    for( cell = 0; cell < 2*ncell; cell++ ) {
+       cheb_power( cheb[cell], degree, pw );
+       for( p = degree; p >= 0; p-- ) {
+          for( q = degree - p; q >= 0; q-- ) *c++ = pw[p][q];
+          }
+       }
+    free( cheb );
+
+    /* Check the fit across each cell, including its edges */
+
+    for( cell = 0; cell < ncell; cell++ ) {
+       xc = t->x0 + (2*(cell % nx) + 1)*hx;
+       yc = t->y0 + (2*(cell / nx) + 1)*hy;
+       for( i = 0; i < TM_APPROX_NCHECK; i++ ) {
+          for( j = 0; j < TM_APPROX_NCHECK; j++ ) {
+             x = xc + (2.0*i/(TM_APPROX_NCHECK-1) - 1.0)*hx;
+             y = yc + (2.0*j/(TM_APPROX_NCHECK-1) - 1.0)*hy;
+             approx_exact( tm, inverse, x, y, &e1, &e2 );
+             if( ! approx_eval( t, x, y, &o1, &o2 ) ) continue;
+             if( fabs(o1 - e1) > tol || fabs(o2 - e2) > tol ) return 0;
+             }
+          }
+       }
+    return 1;
+    }
+
+/* Fits a table, doubling the number of cells until it fits */
+
+static int approx_define( approx_table *t, const tmprojection *tm, 
+              int inverse, double tol ) {
+    int n;
+
+    t->coef = 0;
+    for( n = 1; n <= TM_APPROX_MAXCELL; n *= 2 ) {
+       if( approx_fit( t, tm, inverse, n, n, tol ) ) return 1;
+       }
+    return 0;
+    }
+
+tmapprox *create_tmapprox( const tmprojection *tm, 
+              double emin, double nmin, double emax, double nmax, double tol ) {
+    tmprojection tmc = *tm;
+    tmapprox *ap;
+    double ln, lt, margin;
+    int i, j;
+
+    if( ! (emax > emin && nmax > nmin && tol > 0.0) ) return 0;
+
+    ap = malloc( sizeof(tmapprox) );
+    if( ! ap ) return 0;
+    tmc.approx = 0;
+
+    ap->inv.x0 = emin;
+    ap->inv.y0 = nmin;
+    ap->inv.x1 = emax;
+    ap->inv.y1 = nmax;
+
+    /* The longitude offset and latitude covered by the rectangle, from
+       points around its edges, with a small margin */
+
+    ap->fwd.x0 = ap->fwd.y0 = HUGE_VAL;
+    ap->fwd.x1 = ap->fwd.y1 = -HUGE_VAL;
+    for( i = 0; i <= 64; i++ ) {
+       for( j = 0; j <= 64; j += (i == 0 || i == 64) ? 1 : 64 ) {
+          tm_geod( &tmc, emin + i*(emax-emin)/64, nmin + j*(nmax-nmin)/64,
+                   &ln, &lt );
+          ln = wrap_dlon( ln - tmc.meridian );
+          if( ln < ap->fwd.x0 ) ap->fwd.x0 = ln;
+          if( ln > ap->fwd.x1 ) ap->fwd.x1 = ln;
+          if( lt < ap->fwd.y0 ) ap->fwd.y0 = lt;
+          if( lt > ap->fwd.y1 ) ap->fwd.y1 = lt;
+          }
+       }
+    margin = 0.01*(ap->fwd.x1 - ap->fwd.x0);
+    ap->fwd.x0 -= margin;
+    ap->fwd.x1 += margin;
+    margin = 0.01*(ap->fwd.y1 - ap->fwd.y0);
+    ap->fwd.y0 -= margin;
+    ap->fwd.y1 += margin;
+
+    if( ! approx_define( &ap->inv, &tmc, 1, tol/(tmc.a*tmc.scalef) ) ) {
+       free( ap->inv.coef );
+       free( ap );
+       return 0;
+       }
+    if( ! approx_define( &ap->fwd, &tmc, 0, tol/tmc.utom ) ) {
+       free( ap->inv.coef );
+       free( ap->fwd.coef );
+       free( ap );
+       return 0;
+       }
+    return ap;
+    }
+
+void delete_tmapprox( tmapprox *ap ) {
+    if( ! ap ) return;
+    free( ap->inv.coef );
+    free( ap->fwd.coef );
+    free( ap );
+    }
+
+void set_tmprojection_approx( tmprojection *tm, const tmapprox *ap ) {
+    tm->approx = ap;
+    }
+
+/* Definitions of the built in NZGD2000 projections: the meridional 
+   circuits (LINZ standard LINZS25002), the offshore island TM 
+   projections (LINZS25003), NZTM, and UTM zones 58S to 60S, in the order of the projection 
+   numbers defined in nztm.h.  All use the GRS80 ellipsoid.  The origin 
+   latitude and central meridian are in degrees, minutes, and seconds 
+   (the sign of the degrees applies to the minutes and seconds).  The 
+   projections are calculated from these by WRITE_NZTM_SOURCE. */
+
+typedef struct {
+   const char *name;
+   int code;                   /* EPSG code */
+   int latd, latm, lats;       /* Origin latitude */
+   int lond, lonm, lons;       /* Central meridian */
+   double sf;                  /* Scale factor */
+   double fe, fn;              /* False easting and northing */
+   } projdef;
+
+static const projdef proj_defs[NZGD2000_NPROJECTION] = {
+   { "Mount Eden 2000",           2105, -36,52,47,  174,45,51, 0.9999, 400000, 800000 },
+   { "Bay of Plenty 2000",        2106, -37,45,40,  176,27,58, 1.0, 400000, 800000 },
+   { "Poverty Bay 2000",          2107, -38,37,28,  177,53, 8, 1.0, 400000, 800000 },
+   { "Hawkes Bay 2000",           2108, -39,39, 3,  176,40,25, 1.0, 400000, 800000 },
+   { "Taranaki 2000",             2109, -39, 8, 8,  174,13,40, 1.0, 400000, 800000 },
+   { "Tuhirangi 2000",            2110, -39,30,44,  175,38,24, 1.0, 400000, 800000 },
+   { "Wanganui 2000",             2111, -40,14,31,  175,29,17, 1.0, 400000, 800000 },
+   { "Wairarapa 2000",            2112, -40,55,31,  175,38,50, 1.0, 400000, 800000 },
+   { "Wellington 2000",           2113, -41,18, 4,  174,46,35, 1.0, 400000, 800000 },
+   { "Collingwood 2000",          2114, -40,42,53,  172,40,19, 1.0, 400000, 800000 },
+   { "Nelson 2000",               2115, -41,16,28,  173,17,57, 1.0, 400000, 800000 },
+   { "Karamea 2000",              2116, -41,17,23,  172, 6,32, 1.0, 400000, 800000 },
+   { "Buller 2000",               2117, -41,48,38,  171,34,52, 1.0, 400000, 800000 },
+   { "Grey 2000",                 2118, -42,20, 1,  171,32,59, 1.0, 400000, 800000 },
+   { "Amuri 2000",                2119, -42,41,20,  173, 0,36, 1.0, 400000, 800000 },
+   { "Marlborough 2000",          2120, -41,32,40,  173,48, 7, 1.0, 400000, 800000 },
+   { "Hokitika 2000",             2121, -42,53,10,  170,58,47, 1.0, 400000, 800000 },
+   { "Okarito 2000",              2122, -43, 6,36,  170,15,39, 1.0, 400000, 800000 },
+   { "Jacksons Bay 2000",         2123, -43,58,40,  168,36,22, 1.0, 400000, 800000 },
+   { "Mount Pleasant 2000",       2124, -43,35,26,  172,43,37, 1.0, 400000, 800000 },
+   { "Gawler 2000",               2125, -43,44,55,  171,21,38, 1.0, 400000, 800000 },
+   { "Timaru 2000",               2126, -44,24, 7,  171, 3,26, 1.0, 400000, 800000 },
+   { "Lindis Peak 2000",          2127, -44,44, 6,  169,28, 3, 1.0, 400000, 800000 },
+   { "Mount Nicholas 2000",       2128, -45, 7,58,  168,23,55, 1.0, 400000, 800000 },
+   { "Mount York 2000",           2129, -45,33,49,  167,44,19, 1.0, 400000, 800000 },
+   { "Observation Point 2000",    2130, -45,48,58,  170,37,42, 1.0, 400000, 800000 },
+   { "North Taieri 2000",         2131, -45,51,41,  170,16,57, 0.99996, 400000, 800000 },
+   { "Bluff 2000",                2132, -46,36, 0,  168,20,34, 1.0, 400000, 800000 },
+   { "Chatham Islands TM 2000",   3793,   0, 0, 0, -176,30, 0, 1.0, 3500000, 10000000 },
+   { "Auckland Islands TM 2000",  3788,   0, 0, 0,  166, 0, 0, 1.0, 3500000, 10000000 },
+   { "Campbell Island TM 2000",   3789,   0, 0, 0,  169, 0, 0, 1.0, 3500000, 10000000 },
+   { "Antipodes Islands TM 2000", 3790,   0, 0, 0,  179, 0, 0, 1.0, 3500000, 10000000 },
+   { "Raoul Island TM 2000",      3791,   0, 0, 0, -178, 0, 0, 1.0, 3500000, 10000000 },
+   { "NZTM 2000",                 2193,   0, 0, 0,  173, 0, 0, 0.9996, 1600000, 10000000 },
+   { "UTM zone 58S 2000",         2133,   0, 0, 0,  165, 0, 0, 0.9996, 500000, 10000000 },
+   { "UTM zone 59S 2000",         2134,   0, 0, 0,  171, 0, 0, 0.9996, 500000, 10000000 },
+   { "UTM zone 60S 2000",         2135,   0, 0, 0,  177, 0, 0, 0.9996, 500000, 10000000 }
+   };
+
+#ifndef WRITE_NZTM_SOURCE
+
+/* The built in projections, including NZTM and all of the series 
+   coefficients, are defined as constant data in nztmdef.h, so that 
+   they are initiallized at compile time and can be used by any thread 
+   without locking.  nztmdef.h is generated by compiling this file with
+   WRITE_NZTM_SOURCE defined (see below). */
+
+#include "nztmdef.h"
+
+#define nztm_projection (nzgd2000_projections[NZGD2000_NZTM-1])
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_special, geod_tm_special                                      */
+/*                                                                         */
+/*   Versions of the batch routines specialised for particular built in    */
+/*   projections.  Each calls the (inlined) Redfearn series with a         */
+/*   pointer to the constant definition of the projection in nztmdef.h,    */
+/*   so the compiler can fold the ellipsoid and projection parameters and  */
+/*   series coefficients into the code as constants, rather than loading   */
+/*   them for each point.  The batch routines use these when they are      */
+/*   called with a pointer to one of the projections in TM_SPECIAL_LIST    */
+/*   (for example from the NZTM functions or nzgd2000_projection), and     */
+/*   the runtime parameterised routines for any other projection (such as  */
+/*   a copy of a built in projection), so both are used through the same   */
+/*   interface.  The results are the same (unless the compiler contracts   */
+/*   operations differently into fused multiply-adds).                     */
+/*                                                                         */
+/*   TM_SPECIAL_LIST defines the specialised projections as                */
+/*   TM_SPECIAL(name,number), where number is a built in projection        */
+/*   number.  Other built in projections can be added to the list (and     */
+/*   the list can be defined when compiling to override it).               */
+/*                                                                         */
+/*   The routines return 0 if the projection is not specialised, or uses   */
+/*   TM_KRUGER or an approximation.                                        */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef TM_SPECIAL_LIST
+#define TM_SPECIAL_LIST \
+   TM_SPECIAL(nztm,NZGD2000_NZTM) \
+   TM_SPECIAL(utm58s,NZGD2000_UTM58S) \
+   TM_SPECIAL(utm59s,NZGD2000_UTM59S) \
+   TM_SPECIAL(utm60s,NZGD2000_UTM60S)
+#endif
+
+#define TM_SPECIAL(name,proj) \
+static void tm_geod_##name( int npt, \
+              const double *ce, const double *cn, int instride, \
+              double *ln, double *lt, int outstride ) { \
+    int i; \
+    for( i = 0; i < npt; i++ ) { \
+       tm_geod_calc( &nzgd2000_projections[proj-1], \
+                     ce[i*instride], cn[i*instride], \
+                     ln + i*outstride, lt + i*outstride, 0, 0 ); \
+       } \
+    } \
+static void geod_tm_##name( int npt, \
+              const double *ln, const double *lt, int instride, \
+              double *ce, double *cn, int outstride ) { \
+    double cm = nzgd2000_projections[proj-1].meridian; \
+    int i; \
+    for( i = 0; i < npt; i++ ) { \
+       geod_tm_calc( &nzgd2000_projections[proj-1], \
+                     wrap_dlon( ln[i*instride] - cm ), lt[i*instride], \
+                     ce + i*outstride, cn + i*outstride, 0, 0 ); \
+       } \
+    }
+
+TM_SPECIAL_LIST
+
+#undef TM_SPECIAL
+
+static int tm_geod_special( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, int instride,
+              double *ln, double *lt, int outstride ) {
+    if( tm->method != TM_REDFEARN || tm->approx ) return 0;
+#define TM_SPECIAL(name,proj) \
+    if( tm == &nzgd2000_projections[proj-1] ) { \
+       tm_geod_##name( npt, ce, cn, instride, ln, lt, outstride ); \
+       return 1; \
+       }
+    TM_SPECIAL_LIST
+#undef TM_SPECIAL
+    return 0;
+    }
+
+static int geod_tm_special( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, int instride,
+              double *ce, double *cn, int outstride ) {
+    if( tm->method != TM_REDFEARN || tm->approx ) return 0;
+#define TM_SPECIAL(name,proj) \
+    if( tm == &nzgd2000_projections[proj-1] ) { \
+       geod_tm_##name( npt, ln, lt, instride, ce, cn, outstride ); \
+       return 1; \
+       }
+    TM_SPECIAL_LIST
+#undef TM_SPECIAL
+    return 0;
+    }
+
+/* Functions implementation the TM projection specifically for the
+   NZTM coordinate system
+*/
+
+void nztm_geod( double n, double e, double *lt, double *ln )
+{
+   const tmprojection *nztm = &nztm_projection;
+   tm_geod( nztm, e, n, ln, lt );
+}
+
+void geod_nztm( double lt, double ln, double *n, double *e )
+{
+   const tmprojection *nztm = &nztm_projection;
+   geod_tm( nztm, ln, lt, e, n );
+}
+
+/* Batch versions of the NZTM functions.  The _batch functions take 
+   separate arrays for each coordinate, and the _strided functions 
+   take a stride between successive points (in doubles) for the input
+   and output arrays, so that they can be used with arrays of points */
+
+void nztm_geod_batch( int npt, const double *n, const double *e,
+                      double *lt, double *ln )
+{
+   const tmprojection *nztm = &nztm_projection;
+   tm_geod_batch( nztm, npt, e, n, 1, ln, lt, 1 );
+}
+
+void geod_nztm_batch( int npt, const double *lt, const double *ln,
+                      double *n, double *e )
+{
+   const tmprojection *nztm = &nztm_projection;
+   geod_tm_batch( nztm, npt, ln, lt, 1, e, n, 1 );
+}
+
+void nztm_geod_scale_batch( int npt, const double *n, const double *e,
+                            double *lt, double *ln, double *k, double *conv )
+{
+   const tmprojection *nztm = &nztm_projection;
+   tm_geod_scale_batch( nztm, npt, e, n, 1, ln, lt, k, conv, 1 );
+}
+
+void geod_nztm_scale_batch( int npt, const double *lt, const double *ln,
+                            double *n, double *e, double *k, double *conv )
+{
+   const tmprojection *nztm = &nztm_projection;
+   geod_tm_scale_batch( nztm, npt, ln, lt, 1, e, n, k, conv, 1 );
+}
+
+void nztm_geod_row( double n, int npt, const double *e,
+                    double *lt, double *ln )
+{
+   const tmprojection *nztm = &nztm_projection;
+   tm_geod_row( nztm, n, npt, e, ln, lt );
+}
+
+void nztm_geod_strided( int npt, const double *n, const double *e,
+                        int instride, double *lt, double *ln, int outstride )
+{
+   const tmprojection *nztm = &nztm_projection;
+   tm_geod_batch( nztm, npt, e, n, instride, ln, lt, outstride );
+}
+
+void geod_nztm_strided( int npt, const double *lt, const double *ln,
+                        int instride, double *n, double *e, int outstride )
+{
+   const tmprojection *nztm = &nztm_projection;
+   geod_tm_batch( nztm, npt, ln, lt, instride, e, n, outstride );
+}
+
+void geod_nztm_mm( int npt, const double *lt, const double *ln,
+                   long long *n, long long *e )
+{
+   const tmprojection *nztm = &nztm_projection;
+   geod_tm_fixed( nztm, npt, ln, lt, 0.0, 0.0, 1000.0, e, n );
+}
+
+/* Functions for the built in NZGD2000 projections.  The projections 
+   are defined in nztmdef.h as the array nzgd2000_projections */
+
+const tmprojection *nzgd2000_projection( int proj )
+{
+   if( proj < 1 || proj > NZGD2000_NPROJECTION ) return 0;
+   return &nzgd2000_projections[proj-1];
+}
+
+const char *nzgd2000_projection_name( int proj )
+{
+   if( proj < 1 || proj > NZGD2000_NPROJECTION ) return 0;
+   return proj_defs[proj-1].name;
+}
+
+int nzgd2000_projection_code( int proj )
+{
+   if( proj < 1 || proj > NZGD2000_NPROJECTION ) return 0;
+   return proj_defs[proj-1].code;
+}
+
+int nzgd2000_projection_id( const char *name )
+{
+   int proj;
+   for( proj = 1; proj <= NZGD2000_NPROJECTION; proj++ ) {
+      const char *cname = proj_defs[proj-1].name;
+      const char *c = name;
+      while( *c && 
+             tolower((unsigned char) *c) == tolower((unsigned char) *cname) ) {
+         c++; 
+         cname++;
+         }
+      if( *c == 0 && (*cname == 0 || strcmp(cname," 2000") == 0) ) {
+         return proj;
+         }
+      }
+   return 0;
+}
+
+/***************************************************************************/
+/*                                                                         */
+/*   proj_batch                                                            */
+/*                                                                         */
+/*   Converts points in a mixture of projections.  The points are          */
+/*   processed in chunks of PROJ_CHUNK.  Each chunk is sorted by           */
+/*   projection with a counting sort, the coordinates of each projection   */
+/*   are gathered into contiguous arrays and converted with tm_geod_batch  */
+/*   or geod_tm_batch (so that the vector routines can be used), and the   */
+/*   results are scattered back to the output arrays.                      */
+/*                                                                         */
+/*   The input and output coordinates are in the order used by tm_geod     */
+/*   (easting, northing) or geod_tm (longitude, latitude).  togeod         */
+/*   selects tm_geod.  Returns the number of points converted.             */
+/*                                                                         */
+/***************************************************************************/
+
+#define PROJ_CHUNK 1024
+
+static int proj_batch( int npt, const int *proj, 
+                       const double *in1, const double *in2,
+                       double *out1, double *out2, int togeod )
+{
+   int count[NZGD2000_NPROJECTION+1];
+   int pos[NZGD2000_NPROJECTION+2];
+   double *x1, *x2, *y1, *y2;
+   int *idx;
+   int nchunk, nc, nconv, i0, i, k, c;
+
+   if( npt <= 0 ) return 0;
+   nchunk = npt < PROJ_CHUNK ? npt : PROJ_CHUNK;
+   x1 = (double *) malloc( 4 * nchunk * sizeof(double) );
+   idx = (int *) malloc( nchunk * sizeof(int) );
+
+   /* If there is no memory for the work arrays, convert each point
+      separately */
+
+   if( ! x1 || ! idx ) {
+      free( x1 );
+      free( idx );
+      nconv = 0;
+      for( i = 0; i < npt; i++ ) {
+         const tmprojection *tm = nzgd2000_projection( proj[i] );
+         if( ! tm ) continue;
+         if( togeod ) tm_geod( tm, in1[i], in2[i], out1+i, out2+i );
+         else geod_tm( tm, in1[i], in2[i], out1+i, out2+i );
+         nconv++;
+         }
+      return nconv;
+      }
+   x2 = x1 + nchunk;
+   y1 = x2 + nchunk;
+   y2 = y1 + nchunk;
+
+   nconv = 0;
+   for( i0 = 0; i0 < npt; i0 += nchunk ) {
+      nc = npt - i0 < nchunk ? npt - i0 : nchunk;
+
+      for( c = 0; c <= NZGD2000_NPROJECTION; c++ ) count[c] = 0;
+      for( i = 0; i < nc; i++ ) {
+         c = proj[i0+i];
+         if( c >= 1 && c <= NZGD2000_NPROJECTION ) count[c]++;
+         }
+      pos[1] = 0;
+      for( c = 1; c <= NZGD2000_NPROJECTION; c++ ) {
+         pos[c+1] = pos[c] + count[c];
+         }
+
+      for( i = 0; i < nc; i++ ) {
+         c = proj[i0+i];
+         if( c < 1 || c > NZGD2000_NPROJECTION ) continue;
+         k = pos[c]++;
+         idx[k] = i0+i;
+         x1[k] = in1[i0+i];
+         x2[k] = in2[i0+i];
+         }
+
+      /* pos[c] is now the end of the points of projection c */
+
+      for( c = 1; c <= NZGD2000_NPROJECTION; c++ ) {
+         const tmprojection *tm = &nzgd2000_projections[c-1];
+         k = pos[c] - count[c];
+         if( ! count[c] ) continue;
+         if( togeod ) {
+            tm_geod_batch( tm, count[c], x1+k, x2+k, 1, y1+k, y2+k, 1 );
+            }
+         else {
+            geod_tm_batch( tm, count[c], x1+k, x2+k, 1, y1+k, y2+k, 1 );
+            }
+         }
+
+      k = pos[NZGD2000_NPROJECTION];
+      for( i = 0; i < k; i++ ) {
+         out1[idx[i]] = y1[i];
+         out2[idx[i]] = y2[i];
+         }
+      nconv += k;
+      }
+
+   free( x1 );
+   free( idx );
+   return nconv;
+}
+
+int nzgd2000_geod_batch( int npt, const int *proj, 
+                         const double *n, const double *e,
+                         double *lt, double *ln )
+{
+   return proj_batch( npt, proj, e, n, ln, lt, 1 );
+}
+
+int geod_nzgd2000_batch( int npt, const int *proj, 
+                         const double *lt, const double *ln,
+                         double *n, double *e )
+{
+   return proj_batch( npt, proj, ln, lt, e, n, 0 );
+}
+
+#endif
+
+#ifdef WRITE_NZTM_SOURCE
+
+/* The specialised batch routines need the projections written to 
+   nztmdef.h, so are not used when writing it. */
+
+static int tm_geod_special( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, int instride,
+              double *ln, double *lt, int outstride ) {
+    return 0;
+    }
+
+static int geod_tm_special( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, int instride,
+              double *ce, double *cn, int outstride ) {
+    return 0;
+    }
+
+/* Writes the C source of nztmdef.h, which defines the built in 
+   NZGD2000 projections as constant data.  Doubles are written with 17 significant digits, 
+   so that they are read back exactly, and the results are identical 
+   to those of a projection set up by define_tmprojection.  This must
+   be rerun if the tmprojection structure is changed.  */
+
+#include <stdio.h>
+
+static void write_array( FILE *f, const double *v, int n ) {
+   int i;
+   fprintf(f,"{");
+   for( i = 0; i < n; i++ ) fprintf(f,"%s%.17g", i ? ", " : " ", v[i] );
+   fprintf(f," }");
+   }
+
+static void write_tmprojection( FILE *f, const tmprojection *tm ) {
+   fprintf(f,"    {\n");
+   fprintf(f,"    %.17g, %.17g, %.17g,\n",tm->meridian,tm->scalef,tm->orglat);
+   fprintf(f,"    %.17g, %.17g, %.17g,\n",tm->falsee,tm->falsen,tm->utom);
+   fprintf(f,"    %.17g, %.17g, %.17g,\n",tm->a,tm->rf,tm->f);
+   fprintf(f,"    %.17g, %.17g, %.17g,\n",tm->e2,tm->ep2,tm->om);
+   fprintf(f,"    %.17g, %.17g,\n",tm->e4,tm->e6);
+   fprintf(f,"    %.17g, %.17g, %.17g, %.17g,\n",tm->A0,tm->A2,tm->A4,tm->A6);
+   fprintf(f,"    %.17g, %.17g, %.17g, %.17g,\n",tm->n,tm->n2,tm->n3,tm->n4);
+   fprintf(f,"    %.17g,\n",tm->g);
+   fprintf(f,"    %.17g, %.17g, %.17g, %.17g,\n",
+           tm->fp2,tm->fp4,tm->fp6,tm->fp8);
+   fprintf(f,"    %d, %.17g, %.17g,\n    ",tm->method,tm->e,tm->A);
+   write_array( f, tm->alpha, TM_KRUGER_ORDER );
+   fprintf(f,",\n    ");
+   write_array( f, tm->beta, TM_KRUGER_ORDER );
+   fprintf(f,",\n    %.17g,\n    0\n    }",tm->xi0);
+   }
+
+int main( int argc, char *argv[] ) {
+   tmprojection tm;
+   FILE *f;
+   int i;
+
+   if( argc != 2 ) {
+      printf("Syntax: writenztmsource nztmdef.h\n");
+      return 1;
+      }
+   f = fopen(argv[1],"w");
+   if( ! f ) {
+      fprintf(stderr,"Cannot open %s for writing\n",argv[1]);
+      return 1;
+      }
+
+   fprintf(f,"/* NZGD2000 projection parameters, generated by compiling nztm.c\n");
+   fprintf(f,"   with WRITE_NZTM_SOURCE defined.\n");
+   fprintf(f,"   Do not edit. */\n\n");
+
+   define_tmprojection( &tm, NZTM_A, NZTM_RF,
+       NZTM_CM/rad2deg, NZTM_SF, NZTM_OLAT/rad2deg, NZTM_FE, NZTM_FN,
+       1.0);
+   fprintf(f,"static const tmprojection nzgd2000_projections[%d] = {\n",
+           NZGD2000_NPROJECTION);
+   for( i = 0; i < NZGD2000_NPROJECTION; i++ ) {
+      const projdef *pd = &proj_defs[i];
+      double lat = abs(pd->latd) + pd->latm/60.0 + pd->lats/3600.0;
+      double lon = abs(pd->lond) + pd->lonm/60.0 + pd->lons/3600.0;
+      if( pd->latd < 0 ) lat = -lat;
+      if( pd->lond < 0 ) lon = -lon;
+      define_tmprojection( &tm, NZTM_A, NZTM_RF, lon/rad2deg, pd->sf,
+          lat/rad2deg, pd->fe, pd->fn, 1.0 );
+      fprintf(f,"    /* %s */\n",pd->name);
+      write_tmprojection( f, &tm );
+      fprintf(f,"%s\n",i < NZGD2000_NPROJECTION-1 ? "," : "");
+      }
+   fprintf(f,"    };\n");
+
+   fclose(f);
+   return 0;
+   }
+
+#endif
+
+#ifdef TEST_NZTM
+
+#include <stdio.h>
+
+int main( int argc, char *argv[] ) {
+  double e, n, lt, ln, e1, n1;
+  while(1) {
+     printf("Enter NZTM easting, northing: ");
+     if( scanf("%lf%lf",&e,&n) != 2 ) break;
+     nztm_geod( n, e, &lt, &ln );
+     geod_nztm( lt, ln, &n1, &e1 );
+     printf("\nInput NZTM e,n:  %12.3lf %12.3lf\n",e,n);
+     printf("Output Lat/Long: %12.6lf %12.6lf\n",lt*rad2deg,ln*rad2deg);
+     printf("Output NZTM e,n: %12.3lf %12.3lf\n",e1,n1);
+     printf("Difference:      %12.3lf %12.3lf\n\n",e1-e,n1-n);
+     }
+  return 0;
+  }
+
+#endif
+
+#ifdef BENCH_NZTM
+
+/* Times the single point and batch conversions for a grid of points
+   covering New Zealand, and reports the largest difference between the
+   batch and single point results.  Compile with NZTM_SIMD and nztmsimd.c 
+   to include the vector routines. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_NPT 100000
+#define BENCH_REPEAT 20
+#define BENCH_ROW 1000
+
+static double bench_seconds( clock_t start ) {
+   return (double)(clock()-start)/CLOCKS_PER_SEC;
+   }
+
+#ifdef NZTM_SIMD
+
+/* Error of v in units in the last place of the correctly rounded value
+   of ref */
+
+static double bench_ulp( double v, long double ref ) {
+   double r = fabs( (double) ref );
+   return (double) (fabsl( (long double) v - ref )/(nextafter( r, 2.0*r+1.0 ) - r));
+   }
+
+#endif
+
+int main( int argc, char *argv[] ) {
+   double *e, *n, *lt, *ln, *lt1, *ln1, *e1, *n1;
+   double tsingle, tbatch, diff, maxlt, maxe;
+   clock_t start;
+   int npt = BENCH_NPT;
+   int i, r, level;
+   static const char *levelname[] = { "scalar", "AVX2", "AVX-512" };
+
+   e = (double *) malloc( 8 * npt * sizeof(double) );
+   if( ! e ) return 1;
+   n = e + npt; lt = n + npt; ln = lt + npt;
+   lt1 = ln + npt; ln1 = lt1 + npt; e1 = ln1 + npt; n1 = e1 + npt;
+
+   for( i = 0; i < npt; i++ ) {
+      e[i] = 1000000.0 + 1200000.0*(double)rand()/RAND_MAX;
+      n[i] = 4700000.0 + 1500000.0*(double)rand()/RAND_MAX;
+      }
+
+   start = clock();
+   for( r = 0; r < BENCH_REPEAT; r++ ) {
+      for( i = 0; i < npt; i++ ) nztm_geod( n[i], e[i], lt+i, ln+i );
+      }
+   tsingle = bench_seconds( start );
+   start = clock();
+   for( r = 0; r < BENCH_REPEAT; r++ ) {
+      for( i = 0; i < npt; i++ ) geod_nztm( lt[i], ln[i], n1+i, e1+i );
+      }
+   printf("%-10s nztm_geod %7.1lf ns/point  geod_nztm %7.1lf ns/point\n",
+       "single", tsingle*1.0e9/(npt*BENCH_REPEAT),
+       bench_seconds(start)*1.0e9/(npt*BENCH_REPEAT));
+
+   for( level = TM_SIMD_NONE; level <= TM_SIMD_AVX512; level++ ) {
+#ifdef NZTM_SIMD
+      if( tm_simd_level( level ) != level ) continue;
+#else
+      if( level != TM_SIMD_NONE ) continue;
+#endif
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         nztm_geod_batch( npt, n, e, lt1, ln1 );
+         }
+      tsingle = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_nztm_batch( npt, lt, ln, n1, e1 );
+         }
+      tbatch = bench_seconds( start );
+
+      /* Differences in metres (latitude and longitude differences are
+         converted using the ellipsoid semi-major axis) */
+
+      maxlt = maxe = 0.0;
+      for( i = 0; i < npt; i++ ) {
+         double en, ee;
+         geod_nztm( lt[i], ln[i], &en, &ee );
+         diff = fabs(lt1[i]-lt[i])*NZTM_A;
+         if( diff > maxlt ) maxlt = diff;
+         diff = fabs(ln1[i]-ln[i])*NZTM_A*cos(lt[i]);
+         if( diff > maxlt ) maxlt = diff;
+         diff = fabs(e1[i]-ee);
+         if( diff > maxe ) maxe = diff;
+         diff = fabs(n1[i]-en);
+         if( diff > maxe ) maxe = diff;
+         }
+      printf("%-10s nztm_geod %7.1lf ns/point  geod_nztm %7.1lf ns/point"
+             "  max diff %.2le %.2le m\n",
+          levelname[level], tsingle*1.0e9/(npt*BENCH_REPEAT),
+          tbatch*1.0e9/(npt*BENCH_REPEAT), maxlt, maxe );
+      }
+
+   /* Maximum errors (ulp) of the vector sin and cos for latitudes from 
+      -pi/2 to pi/2, including the end points, compared with the long 
+      double C library functions */
+
+#ifdef NZTM_SIMD
+   for( level = TM_SIMD_AVX2; level <= TM_SIMD_AVX512; level++ ) {
+      double maxs = 0.0, maxc = 0.0, halfpi = 2.0*atan(1.0);
+      if( tm_simd_level( level ) != level ) continue;
+      for( i = 0; i < npt; i++ ) lt[i] = halfpi*(2.0*i/(npt-1) - 1.0);
+      tm_simd_sincos( npt, lt, lt1, ln1 );
+      for( i = 0; i < npt; i++ ) {
+         diff = bench_ulp( lt1[i], sinl( lt[i] ) );
+         if( diff > maxs ) maxs = diff;
+         diff = bench_ulp( ln1[i], cosl( lt[i] ) );
+         if( diff > maxc ) maxc = diff;
+         }
+      printf("%-10s sin max error %.3lf ulp  cos max error %.3lf ulp\n",
+          levelname[level], maxs, maxc );
+      }
+#endif
+
+   /* Compare the Kruger series with Redfearn's formulae, and the 
+      round trip (TM to latitude and longitude and back) errors of 
+      each */
+
+   {
+      tmprojection tmr = nztm_projection;
+      tmprojection tmk = tmr;
+      double maxrt = 0.0, maxkt = 0.0;
+      set_tmprojection_method( &tmk, TM_KRUGER );
+#ifdef NZTM_SIMD
+      tm_simd_level( TM_SIMD_NONE );
+#endif
+
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         tm_geod_batch( &tmk, npt, e, n, 1, ln1, lt1, 1 );
+         }
+      tsingle = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_tm_batch( &tmk, npt, ln1, lt1, 1, e1, n1, 1 );
+         }
+      tbatch = bench_seconds( start );
+
+      tm_geod_batch( &tmr, npt, e, n, 1, ln, lt, 1 );
+      maxlt = maxe = 0.0;
+      for( i = 0; i < npt; i++ ) {
+         double ee, en;
+         diff = fabs(lt1[i]-lt[i])*NZTM_A;
+         if( diff > maxlt ) maxlt = diff;
+         diff = fabs(ln1[i]-ln[i])*NZTM_A*cos(lt[i]);
+         if( diff > maxlt ) maxlt = diff;
+         geod_tm( &tmr, ln1[i], lt1[i], &ee, &en );
+         diff = fabs(ee-e[i]) > fabs(en-n[i]) ? fabs(ee-e[i]) : fabs(en-n[i]);
+         if( diff > maxe ) maxe = diff;
+         geod_tm( &tmr, ln[i], lt[i], &ee, &en );
+         diff = fabs(ee-e[i]) > fabs(en-n[i]) ? fabs(ee-e[i]) : fabs(en-n[i]);
+         if( diff > maxrt ) maxrt = diff;
+         diff = fabs(e1[i]-e[i]) > fabs(n1[i]-n[i]) ? 
+                fabs(e1[i]-e[i]) : fabs(n1[i]-n[i]);
+         if( diff > maxkt ) maxkt = diff;
+         }
+      printf("%-10s nztm_geod %7.1lf ns/point  geod_nztm %7.1lf ns/point\n",
+          "Kruger", tsingle*1.0e9/(npt*BENCH_REPEAT),
+          tbatch*1.0e9/(npt*BENCH_REPEAT) );
+      printf("Kruger - Redfearn latitude/longitude: max diff %.2le m\n",maxlt);
+      printf("Redfearn of Kruger latitude/longitude: max diff %.2le m\n",maxe);
+      printf("Round trip: Redfearn %.2le m  Kruger %.2le m\n",maxrt,maxkt);
+   }
+
+   /* Built in projections with the batch routines specialised at 
+      compile time, compared with the same projections supplied at 
+      runtime (as a copy, which the batch routines do not recognise).
+      The points are offset to each projection's central meridian. */
+
+   {
+      static const int sproj[] = { NZGD2000_NZTM, NZGD2000_UTM59S };
+      double *e2, *n2;
+      int ip;
+
+      e2 = (double *) malloc( 2 * npt * sizeof(double) );
+      if( ! e2 ) return 1;
+      n2 = e2 + npt;
+
+#ifdef NZTM_SIMD
+      tm_simd_level( TM_SIMD_NONE );
+#endif
+      for( ip = 0; ip < (int) (sizeof(sproj)/sizeof(sproj[0])); ip++ ) {
+         const tmprojection *tms = nzgd2000_projection( sproj[ip] );
+         tmprojection tmr = *tms;
+         double de = tms->falsee - NZTM_FE;
+         double tspecial, truntime;
+
+         for( i = 0; i < npt; i++ ) e1[i] = e[i] + de;
+
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            tm_geod_batch( &tmr, npt, e1, n, 1, ln, lt, 1 );
+            geod_tm_batch( &tmr, npt, ln, lt, 1, e2, n2, 1 );
+            }
+         truntime = bench_seconds( start );
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            tm_geod_batch( tms, npt, e1, n, 1, ln1, lt1, 1 );
+            geod_tm_batch( tms, npt, ln1, lt1, 1, e2, n2, 1 );
+            }
+         tspecial = bench_seconds( start );
+
+         maxlt = maxe = 0.0;
+         for( i = 0; i < npt; i++ ) {
+            diff = fabs(lt1[i]-lt[i]) + fabs(ln1[i]-ln[i]);
+            if( diff > maxlt ) maxlt = diff;
+            geod_tm( &tmr, ln[i], lt[i], &de, &diff );
+            diff = fabs(diff-n2[i]) + fabs(de-e2[i]);
+            if( diff > maxe ) maxe = diff;
+            }
+         printf("%-17s runtime %7.1lf ns/point  specialised %7.1lf ns/point"
+                "  max diff %.2le %.2le m\n",
+             nzgd2000_projection_name( sproj[ip] ),
+             truntime*1.0e9/(2*npt*BENCH_REPEAT),
+             tspecial*1.0e9/(2*npt*BENCH_REPEAT), maxlt*NZTM_A, maxe );
+         }
+      free( e2 );
+   }
+
+   /* Rows of points with the same northing, as for reprojecting a 
+      raster, converted with nztm_geod_row and with the batch routine */
+
+   {
+      int nrow = npt/BENCH_ROW;
+      int j;
+
+#ifdef NZTM_SIMD
+      tm_simd_level( TM_SIMD_NONE );
+#endif
+      for( j = 0; j < nrow; j++ ) {
+         for( i = 0; i < BENCH_ROW; i++ ) {
+            e[j*BENCH_ROW+i] = 1000000.0 + 1200000.0*i/BENCH_ROW;
+            n[j*BENCH_ROW+i] = 4700000.0 + 1500000.0*j/nrow;
+            }
+         }
+
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         nztm_geod_batch( nrow*BENCH_ROW, n, e, lt, ln );
+         }
+      tsingle = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         for( j = 0; j < nrow; j++ ) {
+            nztm_geod_row( n[j*BENCH_ROW], BENCH_ROW, e + j*BENCH_ROW,
+                           lt1 + j*BENCH_ROW, ln1 + j*BENCH_ROW );
+            }
+         }
+      tbatch = bench_seconds( start );
+
+      maxlt = 0.0;
+      for( i = 0; i < nrow*BENCH_ROW; i++ ) {
+         diff = fabs(lt1[i]-lt[i]) + fabs(ln1[i]-ln[i]);
+         if( diff > maxlt ) maxlt = diff;
+         }
+      printf("%-10s nztm_geod %7.1lf ns/point  nztm_geod_row %7.1lf ns/point"
+             "  max diff %.2le\n",
+          "row", tsingle*1.0e9/(nrow*BENCH_ROW*BENCH_REPEAT),
+          tbatch*1.0e9/(nrow*BENCH_ROW*BENCH_REPEAT), maxlt );
+
+      for( i = 0; i < npt; i++ ) {
+         e[i] = 1000000.0 + 1200000.0*(double)rand()/RAND_MAX;
+         n[i] = 4700000.0 + 1500000.0*(double)rand()/RAND_MAX;
+         }
+   }
+
+   /* Integer millimetre output, compared with converting to doubles 
+      and rounding them in a second pass */
+
+   {
+      long long *ie, *in, *ie1, *in1;
+      int nbad = 0;
+
+      ie = (long long *) malloc( 4 * npt * sizeof(long long) );
+      if( ! ie ) return 1;
+      in = ie + npt; ie1 = in + npt; in1 = ie1 + npt;
+#ifdef NZTM_SIMD
+      tm_simd_level( TM_SIMD_AVX512 );
+#endif
+
+      nztm_geod_batch( npt, n, e, lt, ln );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_nztm_batch( npt, lt, ln, n1, e1 );
+         for( i = 0; i < npt; i++ ) {
+            in1[i] = llrint( n1[i]*1000.0 );
+            ie1[i] = llrint( e1[i]*1000.0 );
+            }
+         }
+      tsingle = bench_seconds( start );
+      start = clock();
+      for( r = 0; r < BENCH_REPEAT; r++ ) {
+         geod_nztm_mm( npt, lt, ln, in, ie );
+         }
+      tbatch = bench_seconds( start );
+
+      for( i = 0; i < npt; i++ ) {
+         if( in[i] != in1[i] || ie[i] != ie1[i] ) nbad++;
+         }
+      printf("%-10s geod_nztm %7.1lf ns/point  geod_nztm_mm %7.1lf ns/point"
+             "  differences %d\n",
+          "mm", tsingle*1.0e9/(npt*BENCH_REPEAT),
+          tbatch*1.0e9/(npt*BENCH_REPEAT), nbad );
+      free( ie );
+   }
+
+   /* Single precision local frames, centred in NZ, of several sizes.
+      Reports the largest differences from the double precision 
+      routines (for the same float inputs), and the times per point */
+
+   {
+      static const double frange[] = { 10.0e3, 50.0e3, 100.0e3, 400.0e3 };
+      const tmprojection *tm = &nztm_projection;
+      float *fe, *fn, *fln, *flt, *fe1, *fn1;
+      tmframe fr;
+      int ir;
+
+      fe = (float *) malloc( 6 * npt * sizeof(float) );
+      if( ! fe ) return 1;
+      fn = fe + npt; fln = fn + npt; flt = fln + npt;
+      fe1 = flt + npt; fn1 = fe1 + npt;
+
+      for( ir = 0; ir < (int) (sizeof(frange)/sizeof(frange[0])); ir++ ) {
+         double range = frange[ir];
+         define_tmframe( &fr, tm, 1700000.0, 5400000.0, range );
+         for( i = 0; i < npt; i++ ) {
+            fe[i] = (float) (range*(2.0*rand()/RAND_MAX-1.0));
+            fn[i] = (float) (range*(2.0*rand()/RAND_MAX-1.0));
+            }
+
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            tm_geod_frame( &fr, npt, fe, fn, fln, flt );
+            }
+         tsingle = bench_seconds( start );
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            geod_tm_frame( &fr, npt, fln, flt, fe1, fn1 );
+            }
+         tbatch = bench_seconds( start );
+
+         maxlt = maxe = 0.0;
+         for( i = 0; i < npt; i++ ) {
+            double ee, en, fl, ft, dl, dt;
+            tm_geod( tm, fr.ce+fe[i], fr.cn+fn[i], &fl, &ft );
+            dl = (fr.ln+fln[i]-fl)*cos(ft);
+            dt = fr.lt+flt[i]-ft;
+            diff = sqrt( dl*dl + dt*dt )*NZTM_A;
+            if( diff > maxlt ) maxlt = diff;
+            geod_tm( tm, fr.ln+fln[i], fr.lt+flt[i], &ee, &en );
+            dl = fr.ce+fe1[i]-ee;
+            dt = fr.cn+fn1[i]-en;
+            diff = sqrt( dl*dl + dt*dt );
+            if( diff > maxe ) maxe = diff;
+            }
+         printf("frame %3.0lfkm tm_geod %7.1lf ns/point  geod_tm %7.1lf ns/point"
+                "  max diff %.2le %.2le m\n",
+             range/1000.0, tsingle*1.0e9/(npt*BENCH_REPEAT),
+             tbatch*1.0e9/(npt*BENCH_REPEAT), maxlt, maxe );
+         }
+      free( fe );
+   }
+
+   /* Piecewise polynomial approximations of NZTM over the extent of 
+      the test points, for several tolerances.  Reports the cells and
+      degree of each conversion, the time to create the approximation,
+      the times per point, and the largest differences from the exact 
+      routines */
+
+   {
+      static const double tol[] = { 1.0e-3, 1.0e-4, 1.0e-5 };
+      tmprojection tm = nztm_projection;
+      tmapprox *ap;
+      double tcreate;
+      int it;
+
+#ifdef NZTM_SIMD
+      tm_simd_level( TM_SIMD_NONE );
+#endif
+      tm_geod_batch( &tm, npt, e, n, 1, ln, lt, 1 );
+      geod_tm_batch( &tm, npt, ln, lt, 1, e1, n1, 1 );
+
+      for( it = 0; it < (int) (sizeof(tol)/sizeof(tol[0])); it++ ) {
+         start = clock();
+         ap = create_tmapprox( &tm, 1000000.0, 4700000.0, 
+                               2200000.0, 6200000.0, tol[it] );
+         tcreate = bench_seconds( start );
+         if( ! ap ) {
+            printf("approx %.0le m: cannot be fitted\n",tol[it]);
+            continue;
+            }
+         set_tmprojection_approx( &tm, ap );
+
+         /* TM to latitude and longitude, compared with ln, lt */
+
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            tm_geod_batch( &tm, npt, e, n, 1, ln1, lt1, 1 );
+            }
+         tsingle = bench_seconds( start );
+         maxlt = 0.0;
+         for( i = 0; i < npt; i++ ) {
+            diff = fabs(lt1[i]-lt[i])*NZTM_A;
+            if( diff > maxlt ) maxlt = diff;
+            diff = fabs(ln1[i]-ln[i])*NZTM_A*cos(lt[i]);
+            if( diff > maxlt ) maxlt = diff;
+            }
+
+         /* Latitude and longitude to TM (into ln1, lt1), compared with
+            e1, n1 */
+
+         start = clock();
+         for( r = 0; r < BENCH_REPEAT; r++ ) {
+            geod_tm_batch( &tm, npt, ln, lt, 1, ln1, lt1, 1 );
+            }
+         tbatch = bench_seconds( start );
+         maxe = 0.0;
+         for( i = 0; i < npt; i++ ) {
+            diff = fabs(ln1[i]-e1[i]);
+            if( diff > maxe ) maxe = diff;
+            diff = fabs(lt1[i]-n1[i]);
+            if( diff > maxe ) maxe = diff;
+            }
+         set_tmprojection_approx( &tm, 0 );
+
+         printf("approx %.0le m: cells %dx%d degree %d, %dx%d degree %d,"
+                " created in %.2lf s\n", tol[it], 
+                ap->inv.nx, ap->inv.ny, ap->inv.degree, 
+                ap->fwd.nx, ap->fwd.ny, ap->fwd.degree, tcreate );
+         printf("%-10s nztm_geod %7.1lf ns/point  geod_nztm %7.1lf ns/point"
+                "  max diff %.2le %.2le m\n",
+             "approx", tsingle*1.0e9/(npt*BENCH_REPEAT),
+             tbatch*1.0e9/(npt*BENCH_REPEAT), maxlt, maxe );
+         delete_tmapprox( ap );
+         }
+   }
+
+   free( e );
+   return 0;
+   }
 
 #endif
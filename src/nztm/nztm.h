@@ -13,6 +13,175 @@
 #define NZTM_FE    1600000.0 
 #define NZTM_FN    10000000.0
 
+/* Methods for evaluating the TM projection.  TM_REDFEARN uses 
+   Redfearn's formulae (the default).  TM_KRUGER uses Kruger's series
+   in the third flattening to 6th order (Karney, 2011), which is 
+   accurate to a few nanometres throughout NZ and beyond. */
+
+#define TM_REDFEARN 0
+#define TM_KRUGER   1
+
+#define TM_KRUGER_ORDER 6
+
+/* Piecewise polynomial approximation of a TM projection (see 
+   create_tmapprox).  The structure is private to nztm.c. */
+
+typedef struct tmapprox_s tmapprox;
+
+/* Structure used to define a TM projection.  All of the coefficients
+   that depend only on the ellipsoid and projection are calculated by
+   define_tmprojection, so that converting coordinates only evaluates 
+   the series.  The structure is not modified by the conversion 
+   routines, so may be shared between threads.  nztmdef.h initiallizes 
+   this structure, so must be regenerated if it is changed (see 
+   nztm.txt). */
+
+typedef struct {
+	    double meridian;          /* Central meridian */
+	    double scalef;            /* Scale factor */
+	    double orglat;            /* Origin latitude */
+	    double falsee;            /* False easting */
+	    double falsen;            /* False northing */
+	    double utom;              /* Unit to metre conversion */
+
+	    double a, rf, f, e2, ep2;     /* Ellipsoid parameters */
+	    double om;                /* Intermediate calculation */
+
+	    double e4, e6;            /* Powers of e2 */
+	    double A0, A2, A4, A6;    /* Meridian arc coefficients */
+	    double n, n2, n3, n4;     /* Third flattening and powers */
+	    double g;                 /* Foot point latitude scale */
+	    double fp2, fp4, fp6, fp8; /* Foot point latitude coefficients */
+
+	    int method;               /* TM_REDFEARN or TM_KRUGER */
+	    double e;                 /* Eccentricity */
+	    double A;                 /* Rectifying radius */
+	    double alpha[TM_KRUGER_ORDER]; /* Kruger series coefficients */
+	    double beta[TM_KRUGER_ORDER];  /* Inverse series coefficients */
+	    double xi0;               /* Rectifying latitude of origin */
+
+	    const tmapprox *approx;   /* Approximation used, or NULL */
+	    } tmprojection;
+
+/* Routines to define a TM projection, and to convert between TM
+   coordinates and latitude and longitude.  Longitudes and latitudes
+   (including the central meridian and origin latitude) are in radians,
+   and eastings and northings in the projection units (utom is the 
+   number of metres per unit). */
+
+void define_tmprojection( tmprojection *tm, double a, double rf,
+   double cm, double sf, double lto, double fe, double fn, double utom );
+
+/* Selects the method used by a projection defined with 
+   define_tmprojection (which sets TM_REDFEARN).  Returns 0 if the 
+   method is not valid, in which case the method is not changed. */
+
+int set_tmprojection_method( tmprojection *tm, int method );
+
+/* Approximation of a projection by polynomials in each cell of a grid
+   covering the rectangle emin to emax, nmin to nmax of TM coordinates 
+   (and the range of longitude and latitude that it covers).  The 
+   number of cells and the degree of the polynomials are chosen so that
+   the approximation is within tol metres of the projection (using its
+   current method).  create_tmapprox returns NULL if the tolerance 
+   cannot be met or memory cannot be allocated.  
+   
+   set_tmprojection_approx selects an approximation for a projection
+   (or removes it if ap is NULL), after which tm_geod, geod_tm, and the
+   batch routines use it for points within its extents and the exact
+   calculation elsewhere.  It must not be deleted while it is used. */
+
+tmapprox *create_tmapprox( const tmprojection *tm, 
+   double emin, double nmin, double emax, double nmax, double tol );
+void delete_tmapprox( tmapprox *ap );
+void set_tmprojection_approx( tmprojection *tm, const tmapprox *ap );
+
+void tm_geod( const tmprojection *tm, 
+   double ce, double cn, double *ln, double *lt );
+void geod_tm( const tmprojection *tm, 
+   double ln, double lt, double *ce, double *cn );
+
+void tm_geod_batch( const tmprojection *tm, int npt,
+   const double *ce, const double *cn, int instride,
+   double *ln, double *lt, int outstride );
+void geod_tm_batch( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, int instride,
+   double *ce, double *cn, int outstride );
+
+/* As the batch routines, but also return the point scale factor k and
+   grid convergence conv (radians, the bearing of grid north clockwise
+   from true north) of each point.  k and conv use the output stride. */
+
+void tm_geod_scale_batch( const tmprojection *tm, int npt,
+   const double *ce, const double *cn, int instride,
+   double *ln, double *lt, double *k, double *conv, int outstride );
+void geod_tm_scale_batch( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, int instride,
+   double *ce, double *cn, double *k, double *conv, int outstride );
+
+/* Converts a row of points with the same northing cn (for example a
+   row of a raster), calculating the terms that depend only on the 
+   northing once.  The results are identical to tm_geod. */
+
+void tm_geod_row( const tmprojection *tm, double cn, int npt,
+   const double *ce, double *ln, double *lt );
+
+/* Convert arrays of latitude and longitude to fixed point TM 
+   coordinates: (ce-ce0)*scale and (cn-cn0)*scale rounded to the 
+   nearest integer.  For example scale 1000 with ce0 and cn0 zero gives
+   integer millimetres.  The _fixed32 version is for offsets from a 
+   local origin that fit in an int. */
+
+void geod_tm_fixed( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, double ce0, double cn0, 
+   double scale, long long *ce, long long *cn );
+void geod_tm_fixed32( const tmprojection *tm, int npt,
+   const double *ln, const double *lt, double ce0, double cn0, 
+   double scale, int *ce, int *cn );
+
+/* Local frame for single precision (float) conversions, for example
+   for drawing maps.  Coordinates are offsets from the frame origin:
+   easting and northing offsets in projection units, and longitude and
+   latitude offsets in radians.  define_tmframe fits polynomials (of
+   degree up to TM_FRAME_DEGREE) to the projection within range 
+   (projection units) of the origin ce, cn, which the frame routines 
+   evaluate in float arithmetic.  Returns 0 if range is not positive.  The frame
+   does not refer to the projection after it is defined. */
+
+#define TM_FRAME_DEGREE 8
+#define TM_FRAME_NCOEF  ((TM_FRAME_DEGREE+1)*(TM_FRAME_DEGREE+2)/2)
+
+typedef struct {
+	    double ce, cn;            /* Easting and northing of the origin */
+	    double ln, lt;            /* Longitude and latitude of the origin */
+	    double range;             /* Half width of the fitted region */
+	    float fwd[2][TM_FRAME_NCOEF]; /* Easting, northing series */
+	    float inv[2][TM_FRAME_NCOEF]; /* Longitude, latitude series */
+	    float fwdlin[2][2];       /* Leading part of linear terms */
+	    float invlin[2][2];
+	    float fwdscl[2];          /* Scales applied to the offsets */
+	    float invscl[2];
+	    int fwddeg, invdeg;       /* Degrees of the polynomials */
+	    } tmframe;
+
+int define_tmframe( tmframe *fr, const tmprojection *tm,
+   double ce, double cn, double range );
+void tm_geod_frame( const tmframe *fr, int npt,
+   const float *de, const float *dn, float *dln, float *dlt );
+void geod_tm_frame( const tmframe *fr, int npt,
+   const float *dln, const float *dlt, float *de, float *dn );
+
+/* Instruction sets used by the batch routines when compiled with 
+   NZTM_SIMD defined (see nztmsimd.c).  tm_simd_level sets the highest 
+   level that may be used (or just queries it if level is negative),
+   and returns the level that will be used on this processor. */
+
+#define TM_SIMD_NONE   0
+#define TM_SIMD_AVX2   1
+#define TM_SIMD_AVX512 2
+
+int tm_simd_level( int level );
+
 /* Routines to convert NZTM to latitude and longitude
    and vice versa.  Northing (n) and Easting (e) are in
    metres, Latitude (lt) and Longitude (ln) are in
@@ -21,5 +190,85 @@
 void nztm_geod( double n, double e, double *lt, double *ln );
 void geod_nztm( double lt, double ln, double *n, double *e );
 
+/* Batch versions for arrays of points.  The _batch routines take 
+   separate arrays of each coordinate.  The _scale_batch routines also
+   return the point scale factor k and grid convergence conv (radians)
+   of each point.  The _strided routines take the number of doubles 
+   between successive points in the input and output arrays, for 
+   example 2 for arrays of coordinate pairs. */
+
+void nztm_geod_batch( int npt, const double *n, const double *e,
+                      double *lt, double *ln );
+void geod_nztm_batch( int npt, const double *lt, const double *ln,
+                      double *n, double *e );
+
+void nztm_geod_scale_batch( int npt, const double *n, const double *e,
+                            double *lt, double *ln, double *k, double *conv );
+void geod_nztm_scale_batch( int npt, const double *lt, const double *ln,
+                            double *n, double *e, double *k, double *conv );
+
+/* Converts arrays of latitude and longitude to NZTM northings and 
+   eastings in integer millimetres */
+
+void geod_nztm_mm( int npt, const double *lt, const double *ln,
+                   long long *n, long long *e );
+
+/* Converts a row of npt points with the same northing n, as 
+   tm_geod_row */
+
+void nztm_geod_row( double n, int npt, const double *e,
+                    double *lt, double *ln );
+
+void nztm_geod_strided( int npt, const double *n, const double *e,
+                        int instride, double *lt, double *ln, int outstride );
+void geod_nztm_strided( int npt, const double *lt, const double *ln,
+                        int instride, double *n, double *e, int outstride );
+
+/* Built in NZGD2000 projections.  These are numbered from 1 to 
+   NZGD2000_NPROJECTION.  The meridional circuits are numbered from 1 
+   (Mount Eden 2000) to NZGD2000_NCIRCUIT (Bluff 2000), in the order of
+   their EPSG codes (2105 to 2132), followed by the offshore island TM
+   projections, NZTM, and UTM zones 58S to 60S.  nzgd2000_projection 
+   returns a projection (for use with tm_geod etc), or NULL if the 
+   number is not valid.  The batch routines are specialised at compile
+   time for NZTM and the UTM zones (see tm_geod_special in nztm.c).  
+   nzgd2000_projection_name and nzgd2000_projection_code return the name 
+   (eg "Wellington 2000") and EPSG code of a projection, or NULL and 0 
+   if it is not valid.  nzgd2000_projection_id returns the number of a 
+   projection given its name (with or without " 2000", ignoring case), 
+   or 0 if it is not found. */
+
+#define NZGD2000_NCIRCUIT    28
+#define NZGD2000_CHATHAM     29    /* Chatham Islands TM 2000 */
+#define NZGD2000_AUCKLAND_IS 30    /* Auckland Islands TM 2000 */
+#define NZGD2000_CAMPBELL    31    /* Campbell Island TM 2000 */
+#define NZGD2000_ANTIPODES   32    /* Antipodes Islands TM 2000 */
+#define NZGD2000_RAOUL       33    /* Raoul Island TM 2000 */
+#define NZGD2000_NZTM        34    /* NZTM 2000 */
+#define NZGD2000_UTM58S      35    /* UTM zone 58S */
+#define NZGD2000_UTM59S      36    /* UTM zone 59S */
+#define NZGD2000_UTM60S      37    /* UTM zone 60S */
+#define NZGD2000_NPROJECTION 37
+
+const tmprojection *nzgd2000_projection( int proj );
+const char *nzgd2000_projection_name( int proj );
+int nzgd2000_projection_code( int proj );
+int nzgd2000_projection_id( const char *name );
+
+/* Convert arrays of points in a mixture of the built in projections.
+   The proj array gives the projection number of each point.  Points 
+   are grouped by projection and each group converted with the batch 
+   routines, so this is much faster than converting points individually.
+   Points with an invalid projection number are not converted (the 
+   outputs are not changed).  Returns the number of points converted.  
+   Northing (n) and easting (e) are in metres, latitude (lt) and 
+   longitude (ln) in radians. */
+
+int nzgd2000_geod_batch( int npt, const int *proj, 
+                         const double *n, const double *e,
+                         double *lt, double *ln );
+int geod_nzgd2000_batch( int npt, const int *proj, 
+                         const double *lt, const double *ln,
+                         double *n, double *e );
 
 #endif
@@ -0,0 +1,635 @@
+/* NZGD2000 projection parameters, generated by compiling nztm.c
+   with WRITE_NZTM_SOURCE defined.
+   Do not edit. */
+
+static const tmprojection nzgd2000_projections[37] = {
+    /* Mount Eden 2000 */
+    {
+    3.0502101228374632, 0.99990000000000001, -0.64367257999869898,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4083162.9661445357,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.64125568537374744,
+    0
+    },
+    /* Bay of Plenty 2000 */
+    {
+    3.0799146570790445, 1, -0.65905571810030472,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4180982.7337381933,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.65661815868788986,
+    0
+    },
+    /* Poverty Bay 2000 */
+    {
+    3.104688636183742, 1, -0.67412372730918901,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4276812.8484838326,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.67166815948700076,
+    0
+    },
+    /* Hawkes Bay 2000 */
+    {
+    3.0835362152769332, 1, -0.69203759282618649,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4390760.6083967825,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.68956351401386939,
+    0
+    },
+    /* Taranaki 2000 */
+    {
+    3.0408483706552385, 1, -0.68304429904160457,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4333552.9254092053,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.68057911827408724,
+    0
+    },
+    /* Tuhirangi 2000 */
+    {
+    3.0654962982028469, 1, -0.68961837255744984,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4375371.0877402667,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.68714660886052958,
+    0
+    },
+    /* Wanganui 2000 */
+    {
+    3.0628443673671777, 1, -0.70235442796019742,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4456393.8056251928,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.69987112632689508,
+    0
+    },
+    /* Wairarapa 2000 */
+    {
+    3.0656223497599355, 1, -0.7142808445154919,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4532275.1504453802,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.71178819752286493,
+    0
+    },
+    /* Wellington 2000 */
+    {
+    3.050423440857152, 1, -0.72084037362090392,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4574013.7336007571,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.71834319029818117,
+    0
+    },
+    /* Collingwood 2000 */
+    {
+    3.0136939563762932, 1, -0.7106059568126819,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4508892.8653696058,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.70811603861962236,
+    0
+    },
+    /* Nelson 2000 */
+    {
+    3.0246410492957465, 1, -0.72037495248703887,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4571052.1476131044,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.71787807688788097,
+    0
+    },
+    /* Karamea 2000 */
+    {
+    3.0038667830602028, 1, -0.72064160001164912,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4572748.8879011329,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.71814454784805193,
+    0
+    },
+    /* Buller 2000 */
+    {
+    2.9946553231191215, 1, -0.72973185653245298,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4630595.0114908163,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.7272292098931521,
+    0
+    },
+    /* Grey 2000 */
+    {
+    2.9941074836594677, 1, -0.73886089814774558,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4688693.2422411516,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.73635346505542909,
+    0
+    },
+    /* Amuri 2000 */
+    {
+    3.0195941388753962, 1, -0.74506166512913641,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4728158.6421384206,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.74255145721613713,
+    0
+    },
+    /* Marlborough 2000 */
+    {
+    3.0334161769238293, 1, -0.7250873414674236,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4601038.8418860529,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.72258745007341008,
+    0
+    },
+    /* Hokitika 2000 */
+    {
+    2.9841591069231002, 1, -0.74850384226501432,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4750067.7821769947,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.74599226051623913,
+    0
+    },
+    /* Okarito 2000 */
+    {
+    2.9716121288559854, 1, -0.75241144053475717,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4774940.2029960323,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.74989844339172951,
+    0
+    },
+    /* Jacksons Bay 2000 */
+    {
+    2.9427317778722903, 1, -0.76755701993261916,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4871353.2137101404,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.76503998727935052,
+    0
+    },
+    /* Mount Pleasant 2000 */
+    {
+    3.01465388746489, 1, -0.76079871721795223,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4828329.7158279689,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.75828320023832296,
+    0
+    },
+    /* Gawler 2000 */
+    {
+    2.990805902491112, 1, -0.76355730706346536,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4845890.6036064113,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.76104111590792922,
+    0
+    },
+    /* Timaru 2000 */
+    {
+    2.9855117370933959, 1, -0.77496012484316168,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4918484.8957174532,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.77244195954759964,
+    0
+    },
+    /* Lindis Peak 2000 */
+    {
+    2.9577658501234971, 1, -0.78077304087966504,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4955495.1432432644,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.77825437306984713,
+    0
+    },
+    /* Mount Nicholas 2000 */
+    {
+    2.9391102196744021, 1, -0.78771557279315363,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -4999700.3808269324,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.78519675086683194,
+    0
+    },
+    /* Mount York 2000 */
+    {
+    2.9275910466112394, 1, -0.79523503298716247,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -5047582.5866082916,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.79271659196385136,
+    0
+    },
+    /* Observation Point 2000 */
+    {
+    2.9780262138570643, 1, -0.7996419893484481,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -5075646.7644738005,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.79712403632908713,
+    0
+    },
+    /* North Taieri 2000 */
+    {
+    2.9719902835272514, 0.99995999999999996, -0.80043223564865684,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -5080679.3065307699,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.79791439082434612,
+    0
+    },
+    /* Bluff 2000 */
+    {
+    2.9381357441753724, 1, -0.81332343142935937,
+    400000, 800000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, -5162780.2334352219,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    -0.81080823968024496,
+    0
+    },
+    /* Chatham Islands TM 2000 */
+    {
+    -3.0805061297699985, 1, 0,
+    3500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* Auckland Islands TM 2000 */
+    {
+    2.8972465583105933, 1, 0,
+    3500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* Campbell Island TM 2000 */
+    {
+    2.9496064358704235, 1, 0,
+    3500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* Antipodes Islands TM 2000 */
+    {
+    3.1241393610698567, 1, 0,
+    3500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* Raoul Island TM 2000 */
+    {
+    -3.1066860685499136, 1, 0,
+    3500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* NZTM 2000 */
+    {
+    3.0194196059501968, 0.99960000000000004, 0,
+    1600000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* UTM zone 58S 2000 */
+    {
+    2.8797932657906502, 0.99960000000000004, 0,
+    500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* UTM zone 59S 2000 */
+    {
+    2.9845130209103101, 0.99960000000000004, 0,
+    500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    },
+    /* UTM zone 60S 2000 */
+    {
+    3.08923277602997, 0.99960000000000004, 0,
+    500000, 10000000, 1,
+    6378137, 298.25722210100002, 0.0033528106811823188,
+    0.0066943800229007869, 0.0067394967754789573, 0,
+    4.481472389101314e-05, 3.0000679234781296e-07,
+    0.99832429844458481, 0.0025146070728448195, 2.6390466202308984e-06, 3.4180461367752132e-09,
+    0.0016792203946287448, 2.8197811337371174e-06, 4.7350339881607318e-09, 7.9511656421797826e-12,
+    6367449.1457710471,
+    0.0025188265967581894, 3.700949071964019e-06, 7.4478138772111511e-09, 1.7035993573185978e-11,
+    0, 0.081819191042815792, 6367449.145771048,
+    { 0.00083773182472855127, 7.6085278481494758e-07, 1.1976455209422675e-09, 2.4291706548410134e-12, 5.7117578179020346e-15, 1.4911177751870806e-17 },
+    { 0.00083773216816203529, 5.9058702103689608e-08, 1.6734826899173422e-10, 2.1647980825651299e-13, 3.7879781391342152e-16, 7.2487491042440613e-19 },
+    0,
+    0
+    }
+    };
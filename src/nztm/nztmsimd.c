@@ -0,0 +1,198 @@
+#include "nztm.h"
+
+#include <string.h>
+
+/***************************************************************************/
+/*                                                                         */
+/*  nztmsimd.c                                                             */
+/*                                                                         */
+/*  Vector (SIMD) implementations of the TM projection batch routines     */
+/*  for x86-64 processors with AVX2 and FMA, or AVX-512.  These are used  */
+/*  by tm_geod_batch and geod_tm_batch (and so by the NZTM batch           */
+/*  functions) when nztm.c is compiled with NZTM_SIMD defined, and the     */
+/*  input and output arrays are contiguous.  The instruction set is        */
+/*  chosen when the routines are called, according to the processor.      */
+/*                                                                         */
+/*  The vector routines evaluate the same series as the scalar routines,   */
+/*  with vector implementations of sin, cos and sqrt, so the results       */
+/*  differ from the scalar routines only by rounding (well under a         */
+/*  micrometre; see the BENCH_NZTM program in nztm.c).                     */
+/*                                                                         */
+/*  The code uses GCC vector extensions and target attributes.  With       */
+/*  other compilers, or other processors, the routines do nothing and      */
+/*  the scalar code is used.                                               */
+/*                                                                         */
+/***************************************************************************/
+
+static int simd_max_level = TM_SIMD_AVX512;
+
+#if defined(__GNUC__) && defined(__x86_64__) && \
+    (__GNUC__ > 6 || defined(__clang__))
+
+#include <immintrin.h>
+
+#define NZTM_HAVE_SIMD
+
+/* Constants used by the kernels.  pi/2 is split into three parts for
+   accurate argument reduction (each part is pi/2 less the previous parts,
+   rounded to double), and the polynomial coefficients are the Cephes 
+   minimax approximations of sin and cos on -pi/4 to pi/4 */
+
+#define SIMD_PI          3.1415926535898
+#define SIMD_TWOPI       (2.0*SIMD_PI)
+#define SIMD_TWO_OVER_PI 6.36619772367581382433E-1
+#define SIMD_ROUND_MAGIC 6755399441055744.0
+#define SIMD_PIO2_1      1.57079632679489655800E0
+#define SIMD_PIO2_2      6.12323399573676603587E-17
+#define SIMD_PIO2_3     -1.49738490485916977726E-33
+
+static const double simd_sin_poly[6] = {
+    1.58962301576546568060E-10,
+   -2.50507477628578072866E-8,
+    2.75573136213857245213E-6,
+   -1.98412698295895385996E-4,
+    8.33333333332211858878E-3,
+   -1.66666666666666307295E-1 };
+
+static const double simd_cos_poly[6] = {
+   -1.13585365213876817300E-11,
+    2.08757008419747316778E-9,
+   -2.75573141792967388112E-7,
+    2.48015872888517045348E-5,
+   -1.38888888888730564116E-3,
+    4.16666666666665929218E-2 };
+
+/* AVX2 and FMA, 4 doubles per vector */
+
+typedef double simd_v4d __attribute__((vector_size(32)));
+typedef long long simd_v4l __attribute__((vector_size(32)));
+
+#define SIMD_VD simd_v4d
+#define SIMD_VL simd_v4l
+#define SIMD_W 4
+#define SIMD_TARGET __attribute__((target("avx2,fma")))
+#define SIMD_SQRT(x) ((simd_v4d) _mm256_sqrt_pd( (__m256d) (x) ))
+#define SIMD_FMA(a,b,c) ((simd_v4d) _mm256_fmadd_pd( (__m256d) (a), \
+                             (__m256d) (b), (__m256d) (c) ))
+#define SIMD_FN(name) name##_avx2
+
+#include "nztmsimd_kernel.h"
+
+#undef SIMD_VD
+#undef SIMD_VL
+#undef SIMD_W
+#undef SIMD_TARGET
+#undef SIMD_SQRT
+#undef SIMD_FMA
+#undef SIMD_FN
+
+/* AVX-512, 8 doubles per vector */
+
+typedef double simd_v8d __attribute__((vector_size(64)));
+typedef long long simd_v8l __attribute__((vector_size(64)));
+
+#define SIMD_VD simd_v8d
+#define SIMD_VL simd_v8l
+#define SIMD_W 8
+#define SIMD_TARGET __attribute__((target("avx512f")))
+#define SIMD_SQRT(x) ((simd_v8d) _mm512_sqrt_pd( (__m512d) (x) ))
+#define SIMD_FMA(a,b,c) ((simd_v8d) _mm512_fmadd_pd( (__m512d) (a), \
+                             (__m512d) (b), (__m512d) (c) ))
+#define SIMD_FN(name) name##_avx512
+
+#include "nztmsimd_kernel.h"
+
+#endif
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_simd_level                                                         */
+/*                                                                         */
+/*   Sets the highest instruction set that the batch routines may use,     */
+/*   and returns the instruction set that will be used on this processor. */
+/*   A level less than 0 just returns the current level.  This should be  */
+/*   called before the batch routines are used by other threads.          */
+/*                                                                         */
+/***************************************************************************/
+
+int tm_simd_level( int level ) {
+    int available = TM_SIMD_NONE;
+
+    if( level >= 0 ) simd_max_level = level;
+
+#ifdef NZTM_HAVE_SIMD
+    if( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) {
+        available = TM_SIMD_AVX2;
+        }
+    if( __builtin_cpu_supports("avx512f") ) available = TM_SIMD_AVX512;
+#endif
+
+    return available < simd_max_level ? available : simd_max_level;
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_geod_simd, geod_tm_simd                                            */
+/*                                                                         */
+/*   Convert contiguous arrays of points with the vector routines.         */
+/*   Return 1 if the points are converted, or 0 if no vector routines      */
+/*   are available, in which case the scalar routines must be used.        */
+/*                                                                         */
+/***************************************************************************/
+
+int tm_geod_simd( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, double *ln, double *lt ) {
+    switch( tm_simd_level( -1 ) ) {
+#ifdef NZTM_HAVE_SIMD
+        case TM_SIMD_AVX512:
+            tm_geod_array_avx512( tm, npt, ce, cn, ln, lt );
+            return 1;
+        case TM_SIMD_AVX2:
+            tm_geod_array_avx2( tm, npt, ce, cn, ln, lt );
+            return 1;
+#endif
+        default:
+            return 0;
+        }
+    }
+
+int geod_tm_simd( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, double *ce, double *cn ) {
+    switch( tm_simd_level( -1 ) ) {
+#ifdef NZTM_HAVE_SIMD
+        case TM_SIMD_AVX512:
+            geod_tm_array_avx512( tm, npt, ln, lt, ce, cn );
+            return 1;
+        case TM_SIMD_AVX2:
+            geod_tm_array_avx2( tm, npt, ln, lt, ce, cn );
+            return 1;
+#endif
+        default:
+            return 0;
+        }
+    }
+
+/***************************************************************************/
+/*                                                                         */
+/*   tm_simd_sincos                                                        */
+/*                                                                         */
+/*   Evaluates sin and cos of an array of angles (radians) with the        */
+/*   vector routines used by the batch conversions, so that their error    */
+/*   can be measured.  Returns 0 if no vector routines are available.      */
+/*                                                                         */
+/***************************************************************************/
+
+int tm_simd_sincos( int npt, const double *x, double *s, double *c ) {
+    switch( tm_simd_level( -1 ) ) {
+#ifdef NZTM_HAVE_SIMD
+        case TM_SIMD_AVX512:
+            sincos_array_avx512( npt, x, s, c );
+            return 1;
+        case TM_SIMD_AVX2:
+            sincos_array_avx2( npt, x, s, c );
+            return 1;
+#endif
+        default:
+            return 0;
+        }
+    }
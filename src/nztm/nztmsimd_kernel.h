@@ -0,0 +1,317 @@
+/***************************************************************************/
+/*                                                                         */
+/*  nztmsimd_kernel.h                                                      */
+/*                                                                         */
+/*  Vector implementation of the TM projection series, included by         */
+/*  nztmsimd.c once for each instruction set.  This file has no include    */
+/*  guard.  Before including it the following macros must be defined       */
+/*                                                                         */
+/*    SIMD_VD        vector of doubles type (GCC vector extension)         */
+/*    SIMD_VL        vector of long long type of the same size             */
+/*    SIMD_W         number of doubles in the vector                       */
+/*    SIMD_TARGET    function attribute enabling the instruction set       */
+/*    SIMD_SQRT(x)   vector square root                                    */
+/*    SIMD_FMA(a,b,c) vector fused multiply add, a*b+c with one rounding   */
+/*    SIMD_FN(name)  name of a function for this instruction set           */
+/*                                                                         */
+/*  sin and cos reduce the argument to the range -pi/4 to pi/4 with fused */
+/*  multiply adds and a three part pi/2, and evaluate the Cephes minimax   */
+/*  polynomials by Horner's rule.  For arguments between -pi/2 and pi/2    */
+/*  (the latitudes used by the projection) the measured error is under     */
+/*  1 ulp (see the BENCH_NZTM program in nztm.c).                          */
+/*                                                                         */
+/***************************************************************************/
+
+/* Selects elements of a where mask is set, and of b elsewhere */
+
+static SIMD_TARGET SIMD_VD SIMD_FN(vsel)( SIMD_VL mask, SIMD_VD a, SIMD_VD b ) {
+    return (SIMD_VD) ((mask & (SIMD_VL) a) | (~mask & (SIMD_VL) b));
+    }
+
+/* Evaluates the polynomial coef[0]*z^(n-1) + ... + coef[n-1] */
+
+static SIMD_TARGET SIMD_VD SIMD_FN(vpoly)( SIMD_VD z, const double *coef, 
+              int n ) {
+    SIMD_VD p, zero = { 0.0 };
+    int i;
+
+    p = zero + coef[0];
+    for( i = 1; i < n; i++ ) p = SIMD_FMA( p, z, zero + coef[i] );
+    return p;
+    }
+
+static SIMD_TARGET void SIMD_FN(vsincos)( SIMD_VD x, SIMD_VD *s, SIMD_VD *c ) {
+    SIMD_VD y, q, r1, r, rt, rr, rre, hz, w, sr, cr, zero = { 0.0 };
+    SIMD_VL qi, swap;
+
+    /* Round x*2/pi to the nearest integer q.  Adding 1.5*2^52 leaves
+       q in the low bits of the double, which gives the quadrant */
+
+    y = x*SIMD_TWO_OVER_PI + SIMD_ROUND_MAGIC;
+    qi = (SIMD_VL) y;
+    q = y - SIMD_ROUND_MAGIC;
+
+    /* The reduced argument is r + rt, where rt holds the rounding error
+       of r and the last part of pi/2 */
+
+    r1 = SIMD_FMA( -q, zero + SIMD_PIO2_1, x );
+    r = SIMD_FMA( -q, zero + SIMD_PIO2_2, r1 );
+    rt = SIMD_FMA( -q, zero + SIMD_PIO2_2, r1 - r );
+    rt = SIMD_FMA( -q, zero + SIMD_PIO2_3, rt );
+
+    /* cos is formed as w = 1 - r*r/2 plus a correction, which includes
+       the rounding errors of r*r and of w */
+
+    rr = r*r;
+    rre = SIMD_FMA( r, r, -rr );
+    hz = 0.5*rr;
+    w = 1.0 - hz;
+
+    sr = r + SIMD_FMA( r*rr, SIMD_FN(vpoly)( rr, simd_sin_poly, 6 ), 
+                       rt*(1.0 - hz) );
+    cr = w + ((((1.0 - w) - hz) - SIMD_FMA( r, rt, 0.5*rre ))
+              + rr*rr*SIMD_FN(vpoly)( rr, simd_cos_poly, 6 ));
+
+    /* Odd quadrants swap sin and cos, and the sign bits follow from
+       bit 1 of q (for sin) and of q+1 (for cos) */
+
+    swap = -(qi & 1);
+    *s = (SIMD_VD) ((SIMD_VL) SIMD_FN(vsel)( swap, cr, sr ) ^ ((qi & 2) << 62));
+    *c = (SIMD_VD) ((SIMD_VL) SIMD_FN(vsel)( swap, sr, cr ) ^ (((qi+1) & 2) << 62));
+    }
+
+/* Sine and cosine of an array of angles, used by BENCH_NZTM to measure
+   the error of vsincos */
+
+static SIMD_TARGET void SIMD_FN(sincos_array)( int npt, const double *x,
+              double *s, double *c ) {
+    SIMD_VD vx, vs, vc;
+    double px[SIMD_W], ps[SIMD_W], pc[SIMD_W];
+    int i, nr;
+
+    for( i = 0; i + SIMD_W <= npt; i += SIMD_W ) {
+        memcpy( &vx, x+i, sizeof(vx) );
+        SIMD_FN(vsincos)( vx, &vs, &vc );
+        memcpy( s+i, &vs, sizeof(vs) );
+        memcpy( c+i, &vc, sizeof(vc) );
+        }
+
+    nr = npt - i;
+    if( nr > 0 ) {
+        int j;
+        for( j = 0; j < SIMD_W; j++ ) px[j] = j < nr ? x[i+j] : 0.0;
+        memcpy( &vx, px, sizeof(vx) );
+        SIMD_FN(vsincos)( vx, &vs, &vc );
+        memcpy( ps, &vs, sizeof(vs) );
+        memcpy( pc, &vc, sizeof(vc) );
+        memcpy( s+i, ps, nr*sizeof(double) );
+        memcpy( c+i, pc, nr*sizeof(double) );
+        }
+    }
+
+/* Conversion from latitude and longitude to TM, as geod_tm */
+
+static SIMD_TARGET void SIMD_FN(geod_tm_vec)( const tmprojection *tm,
+              SIMD_VD ln, SIMD_VD lt, SIMD_VD *ce, SIMD_VD *cn ) {
+    double fn = tm->falsen;
+    double fe = tm->falsee;
+    double sf = tm->scalef;
+    double e2 = tm->e2;
+    double a = tm->a;
+    double cm = tm->meridian;
+    double om = tm->om;
+    double utom = tm->utom;
+    SIMD_VD dlon, k, m, slt, clt, c2, y2, y1, eslt, eta, rho, psi, wc, wc2;
+    SIMD_VD t, t2, t4, t6, trm1, trm2, trm3, trm4, gce, gcn;
+
+    /* Wrap the longitude into the range -pi to pi, as wrap_dlon */
+
+    dlon = ln - cm;
+    k = (dlon/SIMD_TWOPI + SIMD_ROUND_MAGIC) - SIMD_ROUND_MAGIC;
+    dlon = dlon - k*SIMD_TWOPI;
+
+    /* Meridian arc, with the multiple angle terms summed by Clenshaw's
+       recurrence as meridian_arc_sc */
+
+    SIMD_FN(vsincos)( lt, &slt, &clt );
+
+    c2 = 2.0*(clt-slt)*(clt+slt);
+    y2 = tm->A4 - c2*tm->A6;
+    y1 = c2*y2 + tm->A6 - tm->A2;
+    m = a*(tm->A0*lt + y1*(2.0*slt*clt));
+
+    eslt = (1.0-e2*slt*slt);
+    eta = a/SIMD_SQRT(eslt);
+    rho = eta * (1.0-e2) / eslt;
+    psi = eta/rho;
+
+    wc = clt*dlon;
+    wc2 = wc*wc;
+
+    t = slt/clt;
+    t2 = t*t;
+    t4 = t2*t2;
+    t6 = t2*t4;
+
+    trm1 = (psi-t2)/6.0;
+
+    trm2 = (((4.0*(1.0-6.0*t2)*psi
+                  + (1.0+8.0*t2))*psi
+                  - 2.0*t2)*psi+t4)/120.0;
+
+    trm3 = (61 - 479.0*t2 + 179.0*t4 - t6)/5040.0;
+
+    gce = (sf*eta*dlon*clt)*(((trm3*wc2+trm2)*wc2+trm1)*wc2+1.0);
+    *ce = gce/utom+fe;
+
+    trm2 = ((4.0*psi+1)*psi-t2)/24.0;
+
+    trm3 = ((((8.0*(11.0-24.0*t2)*psi
+                -28.0*(1.0-6.0*t2))*psi
+                +(1.0-32.0*t2))*psi
+                -2.0*t2)*psi
+                +t4)/720.0;
+
+    trm4 = (1385.0-3111.0*t2+543.0*t4-t6)/40320.0;
+
+    gcn = (eta*t)*((((trm4*wc2+trm3)*wc2+trm2)*wc2+1.0/2.0)*wc2);
+    *cn = (gcn+m-om)*sf/utom+fn;
+    }
+
+/* Conversion from TM to latitude and longitude, as tm_geod */
+
+static SIMD_TARGET void SIMD_FN(tm_geod_vec)( const tmprojection *tm,
+              SIMD_VD ce, SIMD_VD cn, SIMD_VD *ln, SIMD_VD *lt ) {
+    double fn = tm->falsen;
+    double fe = tm->falsee;
+    double sf = tm->scalef;
+    double e2 = tm->e2;
+    double a = tm->a;
+    double cm = tm->meridian;
+    double om = tm->om;
+    double utom = tm->utom;
+    SIMD_VD cn1, sig, ssig, csig, c2, y3, y2, y1, d, d2, sd, cd;
+    SIMD_VD fphi, slt, clt, eslt, eta, rho, psi, E, x, x2;
+    SIMD_VD t, t2, t4, trm2, trm3, trm4;
+
+    /* Foot point latitude and its sin and cos, as foot_point_lat */
+
+    cn1  =  (cn - fn)*utom/sf + om;
+    sig = cn1/tm->g;
+    SIMD_FN(vsincos)( sig, &ssig, &csig );
+
+    c2 = 2.0*(csig-ssig)*(csig+ssig);
+    y3 = tm->fp6 + c2*tm->fp8;
+    y2 = tm->fp4 + c2*y3 - tm->fp8;
+    y1 = tm->fp2 + c2*y2 - y3;
+    d = y1*(2.0*ssig*csig);
+    fphi = sig + d;
+
+    d2 = d*d;
+    sd = d*(1.0-d2/6.0*(1.0-d2/20.0));
+    cd = 1.0-d2/2.0*(1.0-d2/12.0*(1.0-d2/30.0));
+    slt = ssig*cd + csig*sd;
+    clt = csig*cd - ssig*sd;
+
+    eslt = (1.0-e2*slt*slt);
+    eta = a/SIMD_SQRT(eslt);
+    rho = eta * (1.0-e2) / eslt;
+    psi = eta/rho;
+
+    E = (ce-fe)*utom;
+    x = E/(eta*sf);
+    x2 = x*x;
+
+    t = slt/clt;
+    t2 = t*t;
+    t4 = t2*t2;
+
+    trm2 = ((-4.0*psi
+                 +9.0*(1-t2))*psi
+                 +12.0*t2)/24.0;
+
+    trm3 = ((((8.0*(11.0-24.0*t2)*psi
+                  -12.0*(21.0-71.0*t2))*psi
+                  +15.0*((15.0*t2-98.0)*t2+15))*psi
+                  +180.0*((-3.0*t2+5.0)*t2))*psi + 360.0*t4)/720.0;
+
+    trm4 = (((1575.0*t2+4095.0)*t2+3633.0)*t2+1385.0)/40320.0;
+
+    *lt = fphi+(t*x*E/(sf*rho))*(((trm4*x2-trm3)*x2+trm2)*x2-1.0/2.0);
+
+    trm2 = (psi+2.0*t2)/6.0;
+
+    trm3 = (((-4.0*(1.0-6.0*t2)*psi
+               +(9.0-68.0*t2))*psi
+               +72.0*t2)*psi
+               +24.0*t4)/120.0;
+
+    trm4 = (((720.0*t2+1320.0)*t2+662.0)*t2+61.0)/5040.0;
+
+    *ln = cm - (x/clt)*(((trm4*x2-trm3)*x2+trm2)*x2-1.0);
+    }
+
+/* Array versions.  The points left over after the last full vector
+   are copied into a padded vector */
+
+static SIMD_TARGET void SIMD_FN(geod_tm_array)( const tmprojection *tm, int npt,
+              const double *ln, const double *lt, double *ce, double *cn ) {
+    SIMD_VD vln, vlt, vce, vcn;
+    double pln[SIMD_W], plt[SIMD_W], pce[SIMD_W], pcn[SIMD_W];
+    int i, nr;
+
+    for( i = 0; i + SIMD_W <= npt; i += SIMD_W ) {
+        memcpy( &vln, ln+i, sizeof(vln) );
+        memcpy( &vlt, lt+i, sizeof(vlt) );
+        SIMD_FN(geod_tm_vec)( tm, vln, vlt, &vce, &vcn );
+        memcpy( ce+i, &vce, sizeof(vce) );
+        memcpy( cn+i, &vcn, sizeof(vcn) );
+        }
+
+    nr = npt - i;
+    if( nr > 0 ) {
+        int j;
+        for( j = 0; j < SIMD_W; j++ ) {
+            pln[j] = j < nr ? ln[i+j] : tm->meridian;
+            plt[j] = j < nr ? lt[i+j] : tm->orglat;
+            }
+        memcpy( &vln, pln, sizeof(vln) );
+        memcpy( &vlt, plt, sizeof(vlt) );
+        SIMD_FN(geod_tm_vec)( tm, vln, vlt, &vce, &vcn );
+        memcpy( pce, &vce, sizeof(vce) );
+        memcpy( pcn, &vcn, sizeof(vcn) );
+        memcpy( ce+i, pce, nr*sizeof(double) );
+        memcpy( cn+i, pcn, nr*sizeof(double) );
+        }
+    }
+
+static SIMD_TARGET void SIMD_FN(tm_geod_array)( const tmprojection *tm, int npt,
+              const double *ce, const double *cn, double *ln, double *lt ) {
+    SIMD_VD vce, vcn, vln, vlt;
+    double pce[SIMD_W], pcn[SIMD_W], pln[SIMD_W], plt[SIMD_W];
+    int i, nr;
+
+    for( i = 0; i + SIMD_W <= npt; i += SIMD_W ) {
+        memcpy( &vce, ce+i, sizeof(vce) );
+        memcpy( &vcn, cn+i, sizeof(vcn) );
+        SIMD_FN(tm_geod_vec)( tm, vce, vcn, &vln, &vlt );
+        memcpy( ln+i, &vln, sizeof(vln) );
+        memcpy( lt+i, &vlt, sizeof(vlt) );
+        }
+
+    nr = npt - i;
+    if( nr > 0 ) {
+        int j;
+        for( j = 0; j < SIMD_W; j++ ) {
+            pce[j] = j < nr ? ce[i+j] : tm->falsee;
+            pcn[j] = j < nr ? cn[i+j] : tm->falsen;
+            }
+        memcpy( &vce, pce, sizeof(vce) );
+        memcpy( &vcn, pcn, sizeof(vcn) );
+        SIMD_FN(tm_geod_vec)( tm, vce, vcn, &vln, &vlt );
+        memcpy( pln, &vln, sizeof(vln) );
+        memcpy( plt, &vlt, sizeof(vlt) );
+        memcpy( ln+i, pln, nr*sizeof(double) );
+        memcpy( lt+i, plt, nr*sizeof(double) );
+        }
+    }